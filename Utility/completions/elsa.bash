@@ -11,16 +11,16 @@ _elsa_complete() {
     local cur prev subs
     cur="${COMP_WORDS[COMP_CWORD]}"
     prev="${COMP_WORDS[COMP_CWORD-1]}"
-    subs="help accuracy speed go count movegen static bestmove readyOk isDraw tune egvalidate uci"
+    subs="help accuracy speed bench prefetch go count movegen static bestmove readyOk isDraw tune egvalidate uci"
 
     case "$prev" in
         difficulty)
             COMPREPLY=($(compgen -W "beginner easy medium hard expert" -- "$cur")); return;;
-        fen|data|dump|output|dir)
+        fen|data|dump|output|dir|evalfile)
             COMPREPLY=($(compgen -f -- "$cur")); return;;   # file paths
     esac
 
     # subcommands + the union of arg-keywords (order-independent CLI, so we offer all)
-    COMPREPLY=($(compgen -W "$subs fen depth time debug pieces oracle threads mirror nocache allfiles iters --all" -- "$cur"))
+    COMPREPLY=($(compgen -W "$subs fen depth time debug pieces oracle threads hash evalfile hce json mirror nocache allfiles iters --all" -- "$cur"))
 }
 complete -F _elsa_complete elsa elsa.exe
@@ -9,14 +9,18 @@
 Register-ArgumentCompleter -Native -CommandName elsa,elsa.exe -ScriptBlock {
     param($wordToComplete, $commandAst, $cursorPosition)
 
-    $subcommands = @('help','accuracy','speed','go','count','movegen','static',
+    $subcommands = @('help','accuracy','speed','bench','prefetch','go','count','movegen','static',
                      'bestmove','readyOk','isDraw','tune','egvalidate','uci')
 
     $flagsBySub = @{
-        go         = @('fen','time','depth','debug')
-        count      = @('fen','depth')
+        go         = @('fen','time','depth','threads','debug','evalfile','hce')
+        accuracy   = @('threads','hash')
+        speed      = @('threads','hash')
+        bench      = @('depth','threads','hash','json')
+        prefetch   = @('hash','depth')
+        count      = @('fen','depth','threads','hash')
         movegen    = @('fen','depth','output')
-        static     = @('fen')
+        static     = @('fen','evalfile','hce')
         bestmove   = @('fen','difficulty','depth','time')
         isDraw     = @('fen')
         egvalidate = @('pieces','oracle','threads','mirror','nocache','allfiles','dump')
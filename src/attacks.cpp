@@ -1,5 +1,6 @@
 
 #include "attacks.h"
+#include "base_utils.h"
 #include "types.h"
 
 template <Color cMy>
@@ -35,8 +36,7 @@ attackSquares<BISHOP>(Square sq, Bitboard occupied)
   Bitboard mask  = plt::bishopMasks[sq];
   uint64_t start = plt::bishopStartIndex[sq];
 
-  uint64_t occupancy = (magic * (occupied & mask)) >> bits;
-  return plt::bishopMovesLookUp[start + occupancy];
+  return plt::bishopMovesLookUp[start + plt::slidingIndex(occupied, mask, magic, bits)];
 }
 
 // Returns all squares attacked by knight on index sq
@@ -57,8 +57,7 @@ attackSquares<ROOK>(Square sq, Bitboard occupied)
   Bitboard mask  = plt::rookMasks[sq];
   uint64_t start = plt::rookStartIndex[sq];
 
-  uint64_t occupancy = (magic * (occupied & mask)) >> bits;
-  return plt::rookMovesLookUp[start + occupancy];
+  return plt::rookMovesLookUp[start + plt::slidingIndex(occupied, mask, magic, bits)];
 }
 
 // Returns all squares attacked by queen on index sq
@@ -77,6 +76,53 @@ attackSquares<KING>(Square sq, Bitboard occupied)
   return plt::kingMasks[sq] + (occupied - occupied);
 }
 
+template <Color c, PieceType pt>
+static Bitboard
+fillPieceAttacks(const ChessBoard& pos, AttackInfo& ai, Square emyKingSq)
+{
+  Bitboard pieceBb  = pos.piece<c, pt>();
+  Bitboard occupied = pos.all();
+  Bitboard squares  = 0;
+
+  while (pieceBb != 0)
+  {
+    const Bitboard attacks = attackSquares<pt>(nextSquare(pieceBb), occupied);
+
+    ai.kingRingHits [c][pt] += (attacks & plt::kingMasks     [emyKingSq]) != 0;
+    ai.kingOuterHits[c][pt] += (attacks & plt::kingOuterMasks[emyKingSq]) != 0;
+    squares |= attacks;
+  }
+
+  return ai.byType[c][pt] = squares;
+}
+
+template <Color c>
+void
+AttackInfo::fill(const ChessBoard& pos) noexcept
+{
+  if (has(c))
+    return;
+
+  const Square emyKingSq = squareNo(pos.piece<~c, KING>());
+
+  kingRingHits [c] = {};
+  kingOuterHits[c] = {};
+
+  byType[c][PAWN] = pawnAttackSquares<c>(pos);
+  byType[c][KING] = plt::kingMasks[squareNo(pos.piece<c, KING>())];
+
+  byType[c][ALL] = byType[c][PAWN] | byType[c][KING]
+    | fillPieceAttacks<c, BISHOP>(pos, *this, emyKingSq)
+    | fillPieceAttacks<c, KNIGHT>(pos, *this, emyKingSq)
+    | fillPieceAttacks<c, ROOK  >(pos, *this, emyKingSq)
+    | fillPieceAttacks<c, QUEEN >(pos, *this, emyKingSq);
+
+  filled |= uint8_t(1 << c);
+}
+
 
 template Bitboard pawnAttackSquares<WHITE>(const ChessBoard& pos);
 template Bitboard pawnAttackSquares<BLACK>(const ChessBoard& pos);
+
+template void AttackInfo::fill<WHITE>(const ChessBoard& pos) noexcept;
+template void AttackInfo::fill<BLACK>(const ChessBoard& pos) noexcept;
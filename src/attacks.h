@@ -30,5 +30,50 @@ template <Color cMy>
 Bitboard
 pawnAttackSquares(const ChessBoard& pos);
 
+/**
+ * Squares attacked by each side, per piece type, for one position.
+ *
+ * Built once per search node and shared: move generation fills the side not
+ * to move (its attacks decide king safety), the evaluation fills whatever is
+ * still missing and reads both, and SEE uses the defender's set to settle
+ * uncontested captures without scanning for attackers.
+ *
+ * Sets use the board's own occupancy, so a slider's attacks stop at the first
+ * piece in the way, the enemy king included. Move generation extends them
+ * through its own king itself.
+ */
+struct AttackInfo
+{
+  // byType[c][pt] : squares attacked by c's pieces of type pt.
+  // byType[c][ALL]: their union.
+  array<array<Bitboard, ALL + 1>, COLOR_NB> byType;
+
+  // How many of c's pieces of type pt attack a square of the enemy king's
+  // ring (kingMasks) and of the ring around it (kingOuterMasks). Kept for
+  // minor and major pieces only.
+  array<array<uint8_t, ALL>, COLOR_NB> kingRingHits;
+  array<array<uint8_t, ALL>, COLOR_NB> kingOuterHits;
+
+  // Bit c is set once side c has been filled.
+  uint8_t filled = 0;
+
+  bool
+  has(Color c) const noexcept
+  { return filled & (1 << c); }
+
+  // Fill side c, unless it already is.
+  template <Color c>
+  void
+  fill(const ChessBoard& pos) noexcept;
+
+  // Fill both sides.
+  void
+  fill(const ChessBoard& pos) noexcept
+  {
+    fill<WHITE>(pos);
+    fill<BLACK>(pos);
+  }
+};
+
 #endif
 
@@ -130,6 +130,34 @@ namespace utils
     return defaultTime;
   }
 
+  size_t
+  getThreads(const vector<string>& args, size_t defaultThreads)
+  {
+    if (hasArg(args, "threads") and !argValue(args, "threads").empty()) {
+      try {
+        const int threads = std::stoi(argValue(args, "threads"));
+        return size_t(std::clamp(threads, 1, int(MAX_THREADS)));
+      } catch (...) {
+        return defaultThreads;
+      }
+    }
+    return defaultThreads;
+  }
+
+  size_t
+  getHash(const vector<string>& args, size_t defaultHash)
+  {
+    if (hasArg(args, "hash") and !argValue(args, "hash").empty()) {
+      try {
+        const int megabytes = std::stoi(argValue(args, "hash"));
+        return size_t(std::clamp(megabytes, 1, int(MAX_HASH_MB)));
+      } catch (...) {
+        return defaultHash;
+      }
+    }
+    return defaultHash;
+  }
+
   string
   getOutputFile(const vector<string>& args, string defaultOutputFile)
   {
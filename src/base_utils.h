@@ -87,6 +87,16 @@ namespace utils
   double
   getTime(const vector<string>& args, double defaultTime);
 
+  // Retrieves the search thread count from the command line arguments,
+  // clamped to 1..MAX_THREADS.
+  size_t
+  getThreads(const vector<string>& args, size_t defaultThreads);
+
+  // Retrieves the transposition table size in MB from the command line
+  // arguments, clamped to 1..MAX_HASH_MB.
+  size_t
+  getHash(const vector<string>& args, size_t defaultHash);
+
   // Retrieves the output file from the command line arguments.
   string
   getOutputFile(const vector<string>& args, string defaultOutputFile);
@@ -1,6 +1,8 @@
 
 
 #include "bitboard.h"
+#include "attacks.h"
+#include "nnue.h"
 
 uint64_t tmpTotalCounter = 0;
 uint64_t tmpThisCounter = 0;
@@ -88,6 +90,8 @@ ChessBoard::setPositionWithFen(const string& fen) noexcept
 
   // Generate hash-value for current position
   hashValue = generateHashkey();
+  pawnKey = generatePawnKey();
+  materialKey = generateMaterialKey();
 }
 
 const string
@@ -169,6 +173,15 @@ ChessBoard::fen() const
 }
 
 
+void
+ChessBoard::makeMove(Move move, bool inSearch) noexcept
+{
+  color == WHITE
+    ? makeMove<WHITE>(move, inSearch)
+    : makeMove<BLACK>(move, inSearch);
+}
+
+template <Color c>
 void
 ChessBoard::makeMove(Move move, bool inSearch) noexcept
 {
@@ -190,6 +203,9 @@ ChessBoard::makeMove(Move move, bool inSearch) noexcept
 
   undoInfoPush(it, ft, move, inSearch);
 
+  if (nnue::enabled())
+    nnue::recordMove(*this, move);
+
   halfmove = (ft != NONE) or (it == PAWN) ? 0 : halfmove + 1;
   fullmove++;
 
@@ -212,20 +228,20 @@ ChessBoard::makeMove(Move move, bool inSearch) noexcept
   if (it == PAWN)
   {
     if (isDoublePawnPush(ip, fp))
-      return makeMoveDoublePawnPush(ip, fp);
+      return makeMoveDoublePawnPush<c>(ip, fp);
 
     if (isEnpassant(fp, ep))
-      return makeMoveEnpassant(ip, fp);
+      return makeMoveEnpassant<c>(ip, fp);
 
     if (isPawnPromotion(fp))
-      return makeMovePawnPromotion(move);
+      return makeMovePawnPromotion<c>(move);
   }
 
   // Check for king moves.
   if (it == KING)
   {
     int oldCsep = csep;
-    int filter = 2047 ^ (384 << (color * 2));
+    constexpr int filter = 2047 ^ (384 << (c * 2));
     csep &= filter;
 
     hashValue ^= tt.hashKey((oldCsep >> 7) + 66);
@@ -242,22 +258,84 @@ ChessBoard::makeMove(Move move, bool inSearch) noexcept
     pieceCt[(fpt & 8) + ALL]--;
     pieceBb[(fpt & 8) + ALL] ^= fPos;
     boardWeight -= pieceValues[ft - 1];
+    materialKey -= materialUnit(fpt);
 
     hashValue ^= tt.hashKeyUpdate(fpt, fp);
+
+    if (ft == PAWN)
+      pawnKey ^= tt.hashKeyUpdate(fpt, fp);
   }
 
   pieceBb[ipt] ^= iPos ^ fPos;
-  pieceBb[(color << 3) + 7] ^= iPos ^ fPos;
+  pieceBb[(c << 3) + 7] ^= iPos ^ fPos;
 
   // Flip the sides.
-  color = ~color;
+  color = ~c;
 
   hashValue ^= tt.hashKeyUpdate(ipt, ip)
              ^ tt.hashKeyUpdate(ipt, fp)
              ^ tt.hashKey(0);
+
+  if (it == PAWN)
+    pawnKey ^= tt.hashKeyUpdate(ipt, ip) ^ tt.hashKeyUpdate(ipt, fp);
 }
 
 
+Key
+ChessBoard::keyAfter(Move move) const noexcept
+{
+  Square ip = Square(move & 63);
+  Square fp = Square((move >> 6) & 63);
+
+  Piece ipt = board[ip];
+  Piece fpt = board[fp];
+
+  Key key = hashValue
+          ^ tt.hashKeyUpdate(ipt, ip)
+          ^ tt.hashKeyUpdate(ipt, fp)
+          ^ tt.hashKey(0);
+
+  if (fpt != NO_PIECE)
+    key ^= tt.hashKeyUpdate(fpt, fp);
+
+  Square ep = enPassantSquare();
+  if (ep != SQUARE_NB)
+    key ^= tt.hashKey(ep + 1);
+
+  return key;
+}
+
+Key
+ChessBoard::generatePawnKey() const
+{
+  Key key = 0;
+
+  for (Color c : { WHITE, BLACK })
+  {
+    Bitboard pawns = pieceBb[make_piece(c, PAWN)];
+    while (pawns > 0)
+    {
+      Square pos = lsbIndex(pawns);
+      pawns &= pawns - 1;
+      key ^= tt.hashKeyUpdate(make_piece(c, PAWN), pos);
+    }
+  }
+
+  return key;
+}
+
+Key
+ChessBoard::generateMaterialKey() const
+{
+  Key key = 0;
+
+  for (int piece = 0; piece < 16; piece++)
+    if ((piece & 7) != 0 and (piece & 7) != ALL)
+      key += materialUnit(piece) * Key(pieceCt[piece]);
+
+  return key;
+}
+
 void
 ChessBoard::makeMoveCastleCheck(PieceType piece, Square sq) noexcept
 {
@@ -276,10 +354,11 @@ ChessBoard::makeMoveCastleCheck(PieceType piece, Square sq) noexcept
   }
 }
 
+template <Color c>
 void
 ChessBoard::makeMoveDoublePawnPush(Square ip, Square fp) noexcept
 {
-  int own = color << 3;
+  constexpr int own = c << 3;
   csep = (csep & 1920) | ((ip + fp) >> 1);
 
   pieceBb[own + 1] ^= (1ULL << ip) ^ (1ULL << fp);
@@ -290,16 +369,18 @@ ChessBoard::makeMoveDoublePawnPush(Square ip, Square fp) noexcept
   hashValue ^= tt.hashKeyUpdate(own + 1, ip)
              ^ tt.hashKeyUpdate(own + 1, fp)
              ^ tt.hashKey(0);
+  pawnKey ^= tt.hashKeyUpdate(own + 1, ip) ^ tt.hashKeyUpdate(own + 1, fp);
 
-  color = ~color;
+  color = ~c;
 }
 
+template <Color c>
 void
 ChessBoard::makeMoveEnpassant(Square ip, Square ep) noexcept
 {
-  int own = color << 3;
-  int emy = own ^ 8;
-  Square capPawnFp = ep - 8 * (2 * color - 1);
+  constexpr int own = c << 3;
+  constexpr int emy = own ^ 8;
+  Square capPawnFp = ep - 8 * (2 * c - 1);
 
   // Remove opp. pawn from the Pieces-table
   pieceBb[emy + PAWN] ^= 1ULL << capPawnFp;
@@ -308,19 +389,24 @@ ChessBoard::makeMoveEnpassant(Square ip, Square ep) noexcept
   pieceCt[emy + ALL ]--;
   board[capPawnFp] = NO_PIECE;
   boardWeight -= pieceValues[PAWN - 1];
+  materialKey -= materialUnit(emy + PAWN);
 
   // Shift own pawn in Pieces-table
   pieceBb[own + PAWN] ^= (1ULL << ip) ^ (1ULL << ep);
   pieceBb[own +  ALL] ^= (1ULL << ip) ^ (1ULL << ep);
 
-  color = ~color;
+  color = ~c;
 
   hashValue ^= tt.hashKeyUpdate(emy + PAWN, capPawnFp);
   hashValue ^= tt.hashKeyUpdate(own + PAWN, ip)
              ^ tt.hashKeyUpdate(own + PAWN, ep)
              ^ tt.hashKey(0);
+  pawnKey ^= tt.hashKeyUpdate(emy + PAWN, capPawnFp)
+           ^ tt.hashKeyUpdate(own + PAWN, ip)
+           ^ tt.hashKeyUpdate(own + PAWN, ep);
 }
 
+template <Color c>
 void
 ChessBoard::makeMovePawnPromotion(Move move) noexcept
 {
@@ -328,8 +414,8 @@ ChessBoard::makeMovePawnPromotion(Move move) noexcept
   Square fp = Square((move >> 6) & 63);
   PieceType cpt = PieceType((move >> 15) & 7);
 
-  int own = color << 3;
-  int emy = own ^ 8;
+  constexpr int own = c << 3;
+  constexpr int emy = own ^ 8;
   PieceType newPt = PieceType(((move >> 18) & 3) + 2);
 
   pieceBb[own + PAWN ] ^= 1ULL << ip;
@@ -339,8 +425,9 @@ ChessBoard::makeMovePawnPromotion(Move move) noexcept
   pieceBb[own + ALL  ] ^= (1ULL << ip) ^ (1ULL << fp);
   boardWeight -= pieceValues[PAWN  - 1];
   boardWeight += pieceValues[newPt - 1];
+  materialKey += materialUnit(own + newPt) - materialUnit(own + PAWN);
 
-  board[fp] = make_piece(color, newPt);
+  board[fp] = make_piece(c, newPt);
 
   if (cpt > 0)
   {
@@ -349,15 +436,17 @@ ChessBoard::makeMovePawnPromotion(Move move) noexcept
     pieceCt[emy + cpt]--;
     pieceCt[emy + ALL]--;
     boardWeight -= pieceValues[cpt - 1];
+    materialKey -= materialUnit(emy + cpt);
 
     hashValue ^= tt.hashKeyUpdate(emy + cpt, fp);
   }
 
-  color = ~color;
+  color = ~c;
 
   hashValue ^= tt.hashKeyUpdate(own + 1, ip);
   hashValue ^= tt.hashKeyUpdate(own + newPt, fp);
   hashValue ^= tt.hashKey(0);
+  pawnKey ^= tt.hashKeyUpdate(own + 1, ip);
 }
 
 template <bool makeMoveCall>
@@ -475,7 +564,8 @@ ChessBoard::undoInfoPush(PieceType it, PieceType ft, Move move, bool inSearch)
   if (!inSearch and ((ft != NONE) or (it == PAWN)))
     undoInfoStackCounter = 0;
 
-  undoInfo[undoInfoStackCounter++] = UndoInfo(move, csep, hashValue, halfmove);
+  undoInfo[undoInfoStackCounter++] = UndoInfo(move, csep, hashValue, pawnKey, materialKey, halfmove, checkState);
+  checkState.valid = false;
 }
 
 
@@ -485,7 +575,10 @@ ChessBoard::undoInfoPop()
   undoInfoStackCounter--;
   csep = undoInfo[undoInfoStackCounter].csep;
   hashValue = undoInfo[undoInfoStackCounter].hash;
+  pawnKey = undoInfo[undoInfoStackCounter].pawnHash;
+  materialKey = undoInfo[undoInfoStackCounter].materialKey;
   halfmove = undoInfo[undoInfoStackCounter].halfmove;
+  checkState = undoInfo[undoInfoStackCounter].checkInfo;
   return undoInfo[undoInfoStackCounter].move;
 }
 
@@ -494,7 +587,7 @@ void
 ChessBoard::addPreviousBoardPositions(const vector<Key>& prevKeys) noexcept
 {
   for (Key key : prevKeys)
-    undoInfo[undoInfoStackCounter++] = UndoInfo(0, 0, key, 0);
+    undoInfo[undoInfoStackCounter++] = UndoInfo(0, 0, key, 0, 0, 0);
 }
 
 bool
@@ -546,12 +639,68 @@ ChessBoard::generateHashkey() const
   return key;
 }
 
+// Own pieces on a `pt` line between the king and an enemy slider. Lifting the
+// king's own blockers off shows the sliders behind them; each pinned piece is
+// where that slider's rays meet the king's.
+template <PieceType pt>
+static Bitboard
+pinnedOnLines(Square kSq, Bitboard kingRays, Bitboard occupied, Bitboard own, Bitboard sliders)
+{
+  Bitboard pinners = attackSquares<pt>(kSq, occupied ^ (kingRays & own)) & sliders & ~kingRays;
+  Bitboard pinned  = 0;
+
+  while (pinners)
+    pinned |= kingRays & attackSquares<pt>(nextSquare(pinners), occupied) & own;
+
+  return pinned;
+}
+
+template <Color c>
+CheckInfo
+ChessBoard::computeCheckInfo() const noexcept
+{
+  constexpr Color e = ~c;
+
+  const Square   kSq      = squareNo(piece<c, KING>());
+  const Bitboard occupied = all();
+  const Bitboard own      = piece<c, ALL>();
+
+  const Bitboard rq = piece<e, ROOK  >() | piece<e, QUEEN>();
+  const Bitboard bq = piece<e, BISHOP>() | piece<e, QUEEN>();
+
+  const Bitboard rookRays   = attackSquares<ROOK  >(kSq, occupied);
+  const Bitboard bishopRays = attackSquares<BISHOP>(kSq, occupied);
+
+  CheckInfo ci;
+  ci.valid    = true;
+  ci.checkers = (rookRays & rq) | (bishopRays & bq)
+              | (plt::knightMasks[kSq]         & piece<e, KNIGHT>())
+              | (plt::pawnCaptureMasks[c][kSq] & piece<e, PAWN  >());
+
+  if (plt::lineMasks[kSq] & rq)
+    ci.pinned |= pinnedOnLines<ROOK  >(kSq, rookRays  , occupied, own, rq);
+  if (plt::diagonalMasks[kSq] & bq)
+    ci.pinned |= pinnedOnLines<BISHOP>(kSq, bishopRays, occupied, own, bq);
+
+  return ci;
+}
+
+template CheckInfo ChessBoard::computeCheckInfo<WHITE>() const noexcept;
+template CheckInfo ChessBoard::computeCheckInfo<BLACK>() const noexcept;
+
+template void ChessBoard::makeMove<WHITE>(Move, bool) noexcept;
+template void ChessBoard::makeMove<BLACK>(Move, bool) noexcept;
+
 void
 ChessBoard::makeNullMove()
 {
   // Save full state so unmakeNullMove can restore it verbatim. A null move is
   // never irreversible, so (unlike undoInfoPush) we never reset the stack.
-  undoInfo[undoInfoStackCounter++] = UndoInfo(NULL_MOVE, csep, hashValue, halfmove);
+  undoInfo[undoInfoStackCounter++] = UndoInfo(NULL_MOVE, csep, hashValue, pawnKey, materialKey, halfmove, checkState);
+  checkState.valid = false;
+
+  if (nnue::enabled())
+    nnue::recordNullMove(*this);
 
   // An en-passant target cannot survive a null move — drop it from the hash
   // before csep is cleared (read while csep still holds the old value).
@@ -574,6 +723,7 @@ ChessBoard::unmakeNullMove()
   csep      = undoInfo[undoInfoStackCounter].csep;
   hashValue = undoInfo[undoInfoStackCounter].hash;
   halfmove  = undoInfo[undoInfoStackCounter].halfmove;
+  checkState = undoInfo[undoInfoStackCounter].checkInfo;
 }
 
 void
@@ -583,6 +733,9 @@ ChessBoard::reset()
   for (int i = 0; i < 16; i++) pieceBb[i] = 0, pieceCt[i] = 0;
   csep = 0;
   hashValue = 0;
+  pawnKey = 0;
+  materialKey = 0;
+  checkState = CheckInfo();
   undoInfoStackCounter = 0;
   color = Color::WHITE;
   boardWeight = 0;
@@ -629,6 +782,8 @@ ChessBoard::operator==(const ChessBoard& other)
   if (color != other.color) return false;
 
   if (hashValue != other.hashValue) return false;
+  if (pawnKey != other.pawnKey) return false;
+  if (materialKey != other.materialKey) return false;
 
   return true;
 }
@@ -657,6 +812,8 @@ ChessBoard::dump(std::ostream& writer)
   writer << "halfmove: " << halfmove << endl;
   writer << "fullmove: " << fullmove << endl;
   writer << "key: " << hashValue << endl;
+  writer << "pawn key: " << pawnKey << endl;
+  writer << "material key: " << materialKey << endl;
 
   writer << "movenum: " << undoInfoStackCounter << endl;
   writer << "undoInfo: \n";
@@ -674,6 +831,16 @@ ChessBoard::integrityCheck() const noexcept
   if ((pieceBb[0] | pieceBb[8]) != 0)
     return false;
 
+  if (materialKey != generateMaterialKey())
+    return false;
+
+  if (checkState.valid)
+  {
+    const CheckInfo ci = color == WHITE ? computeCheckInfo<WHITE>() : computeCheckInfo<BLACK>();
+    if (ci.checkers != checkState.checkers or ci.pinned != checkState.pinned)
+      return false;
+  }
+
   for (Square sq = SQ_A1; sq < SQUARE_NB; ++sq)
   {
     if (board[sq] == NO_PIECE) continue;
@@ -14,6 +14,20 @@ extern uint64_t tmpThisCounter;
 using std::array;
 
 
+// Check and pin state of a position, for its side to move.
+struct CheckInfo
+{
+  // Enemy pieces giving check.
+  Bitboard checkers = 0;
+
+  // Own pieces pinned to the king by an enemy slider.
+  Bitboard pinned = 0;
+
+  // Set once computed for the position it is stored with.
+  bool valid = false;
+};
+
+
 class UndoInfo
 {
   public:
@@ -26,13 +40,22 @@ class UndoInfo
   // Last Position Hash
   Key hash;
 
+  // Last Pawn Hash
+  Key pawnHash;
+
+  // Last Material Key
+  Key materialKey;
+
   // Last HalfMove
   int halfmove;
 
-  UndoInfo() : move(0), csep(0), hash(0), halfmove(0) {}
+  // Last check state, valid or not
+  CheckInfo checkInfo;
+
+  UndoInfo() : move(0), csep(0), hash(0), pawnHash(0), materialKey(0), halfmove(0) {}
 
-  UndoInfo(Move m, int c, Key h, int hm)
-  : move(m), csep(c), hash(h), halfmove(hm) {}
+  UndoInfo(Move m, int c, Key h, Key ph, Key mk, int hm, CheckInfo ci = CheckInfo())
+  : move(m), csep(c), hash(h), pawnHash(ph), materialKey(mk), halfmove(hm), checkInfo(ci) {}
 };
 
 
@@ -60,6 +83,13 @@ class ChessBoard
   // Halfmove and Fullmove
   int halfmove, fullmove;
 
+  // Check state of the current position, filled by checkInfo() on first use.
+  mutable CheckInfo checkState;
+
+  template <Color c>
+  CheckInfo
+  computeCheckInfo() const noexcept;
+
   // MakeMove-Subparts
 
   bool
@@ -81,12 +111,15 @@ class ChessBoard
   void
   makeMoveCastleCheck(PieceType p, Square sq) noexcept;
 
+  template <Color c>
   void
   makeMoveEnpassant(Square ip, Square fp) noexcept;
 
+  template <Color c>
   void
   makeMoveDoublePawnPush(Square ip, Square fp) noexcept;
 
+  template <Color c>
   void
   makeMovePawnPromotion(Move move) noexcept;
 
@@ -94,6 +127,11 @@ class ChessBoard
   void
   makeMoveCastling(Square ip, Square fp) noexcept;
 
+  // A piece's step in materialKey: one 4-bit count field per piece code.
+  static constexpr Key
+  materialUnit(int piece) noexcept
+  { return Key(1) << (4 * piece); }
+
   public:
 
   // White -> 1, Black -> 0
@@ -103,6 +141,15 @@ class ChessBoard
 
   Key hashValue;
 
+  // Zobrist hash of the pawns alone (same keys as hashValue, no side to move,
+  // castling or en-passant). Keys the evaluation's pawn hash table.
+  Key pawnKey;
+
+  // Count of every piece, kings included, in a 4-bit field at 4 * piece
+  // (no count reaches 16). Equal material gives equal keys and nothing else
+  // does, so it keys the evaluation's material table without collisions.
+  Key materialKey;
+
   Weight boardWeight;
 
   ChessBoard();
@@ -118,9 +165,21 @@ class ChessBoard
   void
   makeMove(Move move, bool inSearch = true) noexcept;
 
+  // makeMove() with the side to move fixed at compile time; `c` must be
+  // `color`. The search, which alternates sides every ply, calls this one.
+  template <Color c>
+  void
+  makeMove(Move move, bool inSearch = true) noexcept;
+
   void
   unmakeMove() noexcept;
 
+  // Hash of the position after `move`, without making it. Exact for ordinary
+  // moves and captures; castling-right changes, a new en-passant square and
+  // promotions are ignored, so it is only fit for prefetching.
+  Key
+  keyAfter(Move move) const noexcept;
+
   void
   undoInfoPush(PieceType it, PieceType ft, Move move, bool inSearch);
 
@@ -142,6 +201,12 @@ class ChessBoard
   uint64_t
   generateHashkey() const;
 
+  Key
+  generatePawnKey() const;
+
+  Key
+  generateMaterialKey() const;
+
   void
   makeNullMove();
 
@@ -159,6 +224,33 @@ class ChessBoard
   enPassantSquare() const
   { return Square(csep & 0x7f); }
 
+  // Checkers and pins for the side to move. Computed once per position and
+  // saved on the undo stack by makeMove(), so movegen, the hash-move legality
+  // test and a qsearch of the same position all share one computation, even
+  // across the null move and razoring searches made from it in between.
+  const CheckInfo&
+  checkInfo() const noexcept
+  {
+    if (!checkState.valid)
+      checkState = color == WHITE ? computeCheckInfo<WHITE>() : computeCheckInfo<BLACK>();
+    return checkState;
+  }
+
+  // Depth of the undo stack — moves, null moves and pre-root history entries.
+  int
+  plyCount() const noexcept
+  { return undoInfoStackCounter; }
+
+  // Hash of the position at undo-stack depth `ply` (0..plyCount()).
+  Key
+  hashAt(int ply) const noexcept
+  { return ply == undoInfoStackCounter ? hashValue : undoInfo[ply].hash; }
+
+  // Move played from the position at undo-stack depth `ply` (< plyCount()).
+  Move
+  moveAt(int ply) const noexcept
+  { return undoInfo[ply].move; }
+
   constexpr Piece
   pieceOnSquare(Square sq) const noexcept
   { return board[sq]; }
@@ -226,6 +318,7 @@ class ChessBoard
     pieceBb[p] |= 1ULL << sq;
     pieceBb[(p & 8) + 7] |= 1ULL << sq;
     pieceCt[p]++;
+    materialKey += materialUnit(p);
 
     if ((p & 7) != KING)
       pieceCt[(p & 8) + 7]++;
@@ -239,6 +332,7 @@ class ChessBoard
     pieceBb[p] &= AllSquares ^ (1ULL << sq);
     pieceBb[(p & 8) + 7] &= AllSquares ^ (1ULL << sq);
     pieceCt[p]--;
+    materialKey -= materialUnit(p);
 
     if ((p & 7) != KING)
       pieceCt[(p & 8) + 7]--;
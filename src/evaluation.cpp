@@ -2,7 +2,9 @@
 #include "evaluation.h"
 #include "attacks.h"
 #include "base_utils.h"
+#include "nnue.h"
 #include "types.h"
+#include <memory>
 
 using std::abs;
 using std::min;
@@ -20,43 +22,19 @@ distance(Square s, Square t)
 
 #ifndef THREATS
 
-template <Color cMy, PieceType pt, const MaskTable& mask, Score increment>
-static Score
-attacksKing(const ChessBoard& pos)
-{
-  Score score = VALUE_ZERO;
-  Bitboard pieceBb = pos.piece<cMy, pt>();
-  Bitboard occupied = pos.all();
-  Square kingSqEmy = squareNo(pos.piece<~cMy, KING>());
-
-  while (pieceBb != 0)
-  {
-    Square sq = nextSquare(pieceBb);
-    if ((attackSquares<pt>(sq, occupied) & mask[kingSqEmy]) != 0)
-      score += increment;
-  }
-
-  return score;
-}
-
+// Pieces reaching the enemy king's ring count more than those reaching the
+// ring around it; both tallies come with the node's AttackInfo.
 template <Color cMy>
 static Score
-attackValue(const ChessBoard& pos)
+attackValue(const AttackInfo& attacks)
 {
-  using plt::kingMasks;
-  using plt::kingOuterMasks;
+  const auto& ring  = attacks.kingRingHits [cMy];
+  const auto& outer = attacks.kingOuterHits[cMy];
 
   Score attackValue = VALUE_ZERO;
 
-  attackValue += attacksKing<cMy, KNIGHT, kingMasks, 2>(pos);
-  attackValue += attacksKing<cMy, BISHOP, kingMasks, 3>(pos);
-  attackValue += attacksKing<cMy, ROOK  , kingMasks, 4>(pos);
-  attackValue += attacksKing<cMy, QUEEN , kingMasks, 6>(pos);
-
-  attackValue += attacksKing<cMy, KNIGHT, kingOuterMasks, 1>(pos);
-  attackValue += attacksKing<cMy, BISHOP, kingOuterMasks, 2>(pos);
-  attackValue += attacksKing<cMy, ROOK  , kingOuterMasks, 3>(pos);
-  attackValue += attacksKing<cMy, QUEEN , kingOuterMasks, 4>(pos);
+  attackValue += 2 * ring[KNIGHT] + 3 * ring[BISHOP] + 4 * ring[ROOK] + 6 * ring[QUEEN];
+  attackValue += 1 * outer[KNIGHT] + 2 * outer[BISHOP] + 3 * outer[ROOK] + 4 * outer[QUEEN];
 
   return attackValue / 4;
 }
@@ -112,34 +90,14 @@ openFilesScore(const ChessBoard& pos)
   return (score / 4) + 1;
 }
 
-template <Color cMy, PieceType pt>
-static Bitboard
-genAttackedSquares(const ChessBoard& pos)
-{
-  Bitboard squares = 0;
-  Bitboard pieceBb = pos.piece<cMy, pt>();
-  Bitboard occupied = pos.all();
-
-  while (pieceBb != 0)
-    squares |= attackSquares<pt>(nextSquare(pieceBb), occupied);
-  return squares;
-}
-
 template <Color cMy>
 static Score
-kingMobilityScore(const ChessBoard& pos)
+kingMobilityScore(const ChessBoard& pos, const AttackInfo& attacks)
 {
   const Color cEmy = ~cMy;
   Square kSq = squareNo(pos.piece<cMy, KING>());
   Bitboard piecesMy = pos.piece<cMy, ALL>();
-  Bitboard attackedSquares = 0;
-
-  attackedSquares |= pawnAttackSquares<cEmy>(pos);
-  attackedSquares |= genAttackedSquares<cEmy, BISHOP>(pos);
-  attackedSquares |= genAttackedSquares<cEmy, KNIGHT>(pos);
-  attackedSquares |= genAttackedSquares<cEmy, ROOK>(pos);
-  attackedSquares |= genAttackedSquares<cEmy, QUEEN>(pos);
-  attackedSquares |= genAttackedSquares<cEmy, KING>(pos);
+  Bitboard attackedSquares = attacks.byType[cEmy][ALL];
 
   int x = popCount(attackSquares<KING>(kSq, 0) & ~(piecesMy | attackedSquares));
   return min(x, 3);
@@ -173,7 +131,7 @@ defendersCount(const ChessBoard& pos)
 
 template <bool debug>
 Score
-threats(const ChessBoard& pos)
+threats(const ChessBoard& pos, const AttackInfo& attacks)
 {
   // Attack Value Currently
   //    - Distance of pieces from king
@@ -189,14 +147,14 @@ threats(const ChessBoard& pos)
   // Increase Attack Value if lack of KIngSafety
   // Threat = Attack_Value * Lack_Of_Safety + Long_Term_Prospects
 
-  Score attackValueWhite = attackValue<WHITE>(pos);
-  Score attackValueBlack = attackValue<BLACK>(pos);
+  Score attackValueWhite = attackValue<WHITE>(attacks);
+  Score attackValueBlack = attackValue<BLACK>(attacks);
 
   Score distanceScoreWhite = attackDistanceScore<WHITE>(pos);
   Score distanceScoreBlack = attackDistanceScore<BLACK>(pos);
 
-  Score kingMobilityWhite = kingMobilityScore<WHITE>(pos);
-  Score kingMobilityBlack = kingMobilityScore<BLACK>(pos);
+  Score kingMobilityWhite = kingMobilityScore<WHITE>(pos, attacks);
+  Score kingMobilityBlack = kingMobilityScore<BLACK>(pos, attacks);
 
   Score openFileDeductionWhite = openFilesScore<WHITE>(pos);
   Score openFileDeductionBlack = openFilesScore<BLACK>(pos);
@@ -344,17 +302,8 @@ pieceTableStrengthMidGame(const ChessBoard& pos)
 
 template <Color cMy, PieceType pt>
 static Score
-addMobilityScore(const ChessBoard& pos)
-{
-  Bitboard pieceBb = pos.piece<cMy, pt>();
-  Bitboard occupied = pos.all();
-  Bitboard squares  = 0;
-
-  while (pieceBb > 0)
-    squares |= attackSquares<pt>(nextSquare(pieceBb), occupied);
-
-  return popCount(squares);
-}
+addMobilityScore(const AttackInfo& attacks)
+{ return popCount(attacks.byType[cMy][pt]); }
 
 // White-relative per-piece-type mobility subtotals (raw popcount diffs, no per-piece
 // scaling — the EvalWeights scalars do that). Used by both the live eval and the
@@ -373,13 +322,13 @@ struct MobilityDiffs
 };
 
 static MobilityDiffs
-mobilityDiffs(const ChessBoard& pos)
+mobilityDiffs(const AttackInfo& attacks)
 {
   return {
-    float(addMobilityScore<WHITE, BISHOP>(pos) - addMobilityScore<BLACK, BISHOP>(pos)),
-    float(addMobilityScore<WHITE, KNIGHT>(pos) - addMobilityScore<BLACK, KNIGHT>(pos)),
-    float(addMobilityScore<WHITE, ROOK  >(pos) - addMobilityScore<BLACK, ROOK  >(pos)),
-    float(addMobilityScore<WHITE, QUEEN >(pos) - addMobilityScore<BLACK, QUEEN >(pos)),
+    float(addMobilityScore<WHITE, BISHOP>(attacks) - addMobilityScore<BLACK, BISHOP>(attacks)),
+    float(addMobilityScore<WHITE, KNIGHT>(attacks) - addMobilityScore<BLACK, KNIGHT>(attacks)),
+    float(addMobilityScore<WHITE, ROOK  >(attacks) - addMobilityScore<BLACK, ROOK  >(attacks)),
+    float(addMobilityScore<WHITE, QUEEN >(attacks) - addMobilityScore<BLACK, QUEEN >(attacks)),
   };
 }
 
@@ -408,9 +357,10 @@ canSafelyPromote(const ChessBoard& pos, Square pawnSq)
   return false;
 }
 
-template <Color cMy>
+// Doubled-pawn penalty: `weight` per pair of pawns sharing a file.
+template <Color cMy, int weight>
 static Score
-pawnStructureScoreMidgame(const ChessBoard& pos)
+doubledPawnScore(const ChessBoard& pos)
 {
   Bitboard  pawns = pos.piece<cMy , PAWN>();
   Bitboard column = FileA;
@@ -420,27 +370,127 @@ pawnStructureScoreMidgame(const ChessBoard& pos)
   for (int i = 0; i < 8; i++)
   {
     int p = popCount(column & pawns);
-    score -= 36 * p * (p - 1);
+    score -= weight * p * (p - 1);
     column <<= 1;
   }
 
   return score;
 }
 
+template <Color cMy>
+static Score
+pawnStructureScoreMidgame(const ChessBoard& pos)
+{ return doubledPawnScore<cMy, 36>(pos); }
+
+// Distance of a pawn from its own back rank, 0..7.
+template <Color cMy>
+static Score
+rankProgress(Square pawnSq)
+{ return (7 * (cMy ^ 1)) + (pawnSq >> 3) * (2 * cMy - 1); }
+
+
+// --- Pawn hash table ---------------------------------------------------------
+//
+// Every term below depends on the pawns alone, and pawn structure changes on a
+// small fraction of moves, so they are computed once per pawn structure and
+// cached under ChessBoard::pawnKey. Terms that also read the kings or the side
+// to move (canSafelyPromote, king-to-pawn distances) stay in the eval proper.
+
+struct PawnEntry
+{
+  Key      key;
+  Bitboard passed[COLOR_NB];
+  Score    doubledMg[COLOR_NB];    // pawnStructureScoreMidgame
+  Score    doubledEg[COLOR_NB];    // doubled part of pawnStructureScoreEndgame
+  Score    passedRank[COLOR_NB];   // sum of 3 * rankProgress^2 over passers
+  int      isolated[COLOR_NB];     // isolatedPawnCount
+};
+
+constexpr size_t PAWN_TABLE_SIZE = 1 << 14;
+
+template <Color cMy>
+static void
+computePawnTerms(const ChessBoard& pos, PawnEntry& pe)
+{
+  pe.doubledMg[cMy]  = pawnStructureScoreMidgame<cMy>(pos);
+  pe.doubledEg[cMy]  = doubledPawnScore<cMy, 52>(pos);
+  pe.isolated[cMy]   = isolatedPawnCount<cMy>(pos);
+  pe.passed[cMy]     = 0;
+  pe.passedRank[cMy] = 0;
+
+  Bitboard pawns = pos.piece<cMy, PAWN>();
+  while (pawns != 0)
+  {
+    Square pawnSq = nextSquare(pawns);
+
+    if (isPassedPawn<cMy>(pos, pawnSq))
+    {
+      Score rp = rankProgress<cMy>(pawnSq);
+      pe.passed[cMy] |= 1ULL << pawnSq;
+      pe.passedRank[cMy] += 3 * rp * rp;
+    }
+  }
+}
+
+static void
+computePawnEntry(const ChessBoard& pos, PawnEntry& pe)
+{
+  pe.key = pos.pawnKey;
+  computePawnTerms<WHITE>(pos, pe);
+  computePawnTerms<BLACK>(pos, pe);
+}
+
+// --- Material hash table -----------------------------------------------------
+//
+// Everything in the evaluation that depends on material alone: the phase, the
+// material balance, the bishop pair and which special endgame (if any) the
+// position belongs to. Material changes only on captures and promotions, so an
+// entry is computed once per material signature and looked up under
+// ChessBoard::materialKey from then on.
+
+enum class EndgameRoute : uint8_t
+{
+  NONE, MINOR_PIECE_PAWN, LONE_KING_WHITE, LONE_KING_BLACK
+};
+
+struct MaterialEntry
+{
+  Key          key = 0;
+  EvalData     ed;
+  Score        materialMg = 0;             // materialDiffereceMidGame
+  Score        materialEg = 0;             // materialDiffereceEndGame
+  int          bishopPair = 0;             // bishopPairDiff
+  int          kingDistanceMaterial = 0;   // material factor of distanceBetweenKingsScore
+  EndgameRoute route = EndgameRoute::NONE;
+};
+
+constexpr int    MATERIAL_TABLE_BITS = 12;
+constexpr size_t MATERIAL_TABLE_SIZE = size_t(1) << MATERIAL_TABLE_BITS;
+
+static int
+kingDistanceMaterial(const ChessBoard& pos)
+{
+  return
+    + 3 * (pos.count<WHITE, BISHOP>() - pos.count<BLACK, BISHOP>())
+    + 3 * (pos.count<WHITE, KNIGHT>() - pos.count<BLACK, KNIGHT>())
+    + 5 * (pos.count<WHITE, ROOK  >() - pos.count<BLACK, ROOK  >())
+    + 9 * (pos.count<WHITE, QUEEN >() - pos.count<BLACK, QUEEN >());
+}
+
 template<bool debug>
 static Score
-midGameScore(const ChessBoard& pos, float /*phase*/)
+midGameScore(const ChessBoard& pos, const MaterialEntry& me, const PawnEntry& pe,
+             const AttackInfo& attacks)
 {
-  Score materialScore   = materialDiffereceMidGame(pos);
+  Score materialScore   = me.materialMg;
   Score pieceTableScore = pieceTableStrengthMidGame(pos);
-  MobilityDiffs mob     = mobilityDiffs(pos);
-  Score pawnStructure   = pawnStructureScoreMidgame<WHITE>(pos)
-                        - pawnStructureScoreMidgame<BLACK>(pos);
-  Score threatsScore    = threats<debug>(pos);
+  MobilityDiffs mob     = mobilityDiffs(attacks);
+  Score pawnStructure   = pe.doubledMg[WHITE] - pe.doubledMg[BLACK];
+  Score threatsScore    = threats<debug>(pos, attacks);
 
-  int   bishopPair = bishopPairDiff(pos);
+  int   bishopPair = me.bishopPair;
   Score rookFile   = rookFileUnits<WHITE>(pos) - rookFileUnits<BLACK>(pos);
-  int   isolated   = isolatedPawnCount<WHITE>(pos) - isolatedPawnCount<BLACK>(pos);
+  int   isolated   = pe.isolated[WHITE] - pe.isolated[BLACK];
 
   if (debug)
   {
@@ -488,22 +538,20 @@ materialDiffereceEndGame(const ChessBoard& pos)
 }
 
 static Score
-distanceBetweenKingsScore(const ChessBoard& pos)
+distanceBetweenKingsScore(const ChessBoard& pos, int materialDiff)
 {
   Square wkSq = squareNo(pos.piece<WHITE, KING>());
   Square bkSq = squareNo(pos.piece<BLACK, KING>());
 
-  int materialDiff =
-    + 3 * (pos.count<WHITE, BISHOP>() - pos.count<BLACK, BISHOP>())
-    + 3 * (pos.count<WHITE, KNIGHT>() - pos.count<BLACK, KNIGHT>())
-    + 5 * (pos.count<WHITE, ROOK  >() - pos.count<BLACK, ROOK  >())
-    + 9 * (pos.count<WHITE, QUEEN >() - pos.count<BLACK, QUEEN >());
-
   int dist = 14 - distance(wkSq, bkSq);
   Score score = (dist / 4) * (dist + 2) * materialDiff;
   return score;
 }
 
+static Score
+distanceBetweenKingsScore(const ChessBoard& pos)
+{ return distanceBetweenKingsScore(pos, kingDistanceMaterial(pos)); }
+
 template <Color winningSide, bool debug>
 static Score
 loneKingEndGame(const ChessBoard& pos)
@@ -581,38 +629,31 @@ pieceTableStrengthEndGame(const ChessBoard& pos)
 
 template <Color cMy>
 static Score
-pawnStructureScoreEndgame(const ChessBoard& pos, const EvalData& ed)
+pawnStructureScoreEndgame(const ChessBoard& pos, const EvalData& ed, const PawnEntry& pe)
 {
   constexpr Color cEmy = ~cMy;
   Bitboard    pawns = pos.piece<cMy , PAWN>();
-  Bitboard   column = FileA;
-  Score score = 0;
+  Bitboard   passed = pe.passed[cMy];
 
-  // Punish Double Pawns on same column
-  for (int i = 0; i < 8; i++)
+  // Doubled-pawn penalty and the passed-pawn reward come from the pawn table
+  Score score = pe.doubledEg[cMy] + pe.passedRank[cMy];
+
+  while (passed != 0)
   {
-    int p = popCount(column & pawns);
-    score -= 52 * p * (p - 1);
-    column <<= 1;
+    Square pawnSq = nextSquare(passed);
+
+    if (canSafelyPromote<cMy>(pos, pawnSq))
+    {
+      Score rp = rankProgress<cMy>(pawnSq);
+      Score reward = ed.pieces[cEmy] == 0 ? QueenValueEg : PawnValueEg >> 2;
+      score += reward + 3 * rp * rp;
+    }
   }
 
   while (pawns != 0)
   {
     Square pawnSq = nextSquare(pawns);
 
-    if (isPassedPawn<cMy>(pos, pawnSq))
-    {
-      // Reward for passed pawn
-      Score rankProgress = (7 * (cMy ^ 1)) + (pawnSq >> 3) * (2 * cMy - 1);
-      score += 3 * rankProgress * rankProgress;
-
-      if (canSafelyPromote<cMy>(pos, pawnSq))
-      {
-        Score reward = ed.pieces[cEmy] == 0 ? QueenValueEg : PawnValueEg >> 2;
-        score += reward + 3 * rankProgress * rankProgress;
-      }
-    }
-
     Square  kpos = squareNo(pos.piece< cMy, KING>());
     Square ekpos = squareNo(pos.piece<cEmy, KING>());
 
@@ -628,21 +669,21 @@ pawnStructureScoreEndgame(const ChessBoard& pos, const EvalData& ed)
 
 template<bool debug>
 static Score
-endGameScore(const ChessBoard& pos, const EvalData& ed, float /*phase*/)
+endGameScore(const ChessBoard& pos, const MaterialEntry& me, const PawnEntry& pe)
 {
   // Distance between kings
   // King in corners
   // BN endgames
   // Rule of Square (2n1k1r1/p7/3B1Rp1/2P2pKp/8/4P1P1/5P1P/8 w - - 17 45)
 
-  Score materialScore   = materialDiffereceEndGame(pos);
+  Score materialScore   = me.materialEg;
   Score pieceTableScore = pieceTableStrengthEndGame(pos);
-  Score pawnStructure   = pawnStructureScoreEndgame<WHITE>(pos, ed)
-                        - pawnStructureScoreEndgame<BLACK>(pos, ed);
-  Score distanceScore   = distanceBetweenKingsScore(pos);
+  Score pawnStructure   = pawnStructureScoreEndgame<WHITE>(pos, me.ed, pe)
+                        - pawnStructureScoreEndgame<BLACK>(pos, me.ed, pe);
+  Score distanceScore   = distanceBetweenKingsScore(pos, me.kingDistanceMaterial);
 
-  int bishopPair = bishopPairDiff(pos);
-  int isolated   = isolatedPawnCount<WHITE>(pos) - isolatedPawnCount<BLACK>(pos);
+  int bishopPair = me.bishopPair;
+  int isolated   = pe.isolated[WHITE] - pe.isolated[BLACK];
 
   if (debug)
   {
@@ -676,40 +717,180 @@ Score minorPiecePawnEndgame(const ChessBoard& pos)
   return pos.piece<WHITE, PAWN>() ? (20 * row) : -(20 * (7 - row));
 }
 
-template <bool debug>
-Score
-evaluate(const ChessBoard& pos)
+// The special endgame evaluatePosition() hands the position to, if any.
+static EndgameRoute
+endgameRoute(const ChessBoard& pos, const EvalData& ed)
 {
-  EvalData ed = EvalData(pos);
-  int side2move = 2 * int(pos.color) - 1;
-  float phase = ed.phase;
-  int pieceCount = pos.count<ALL>();
+  if ((pos.count<ALL>() == 2) and
+      (pos.count<PAWN  >() == 1) and
+      (pos.count<BISHOP>() == 1 or pos.count<KNIGHT>() == 1) and
+      (pos.count<WHITE, ALL>() == 1)
+  ) return EndgameRoute::MINOR_PIECE_PAWN;
 
-  if (pieceCount < 3)
+  if ((pos.count<PAWN>() == 0) and (ed.pieces[WHITE] == 0 or ed.pieces[BLACK] == 0))
+    return ed.pieces[WHITE] > 0 ? EndgameRoute::LONE_KING_WHITE : EndgameRoute::LONE_KING_BLACK;
+
+  return EndgameRoute::NONE;
+}
+
+static void
+computeMaterialEntry(const ChessBoard& pos, MaterialEntry& me)
+{
+  me.key        = pos.materialKey;
+  me.ed         = EvalData(pos);
+  me.materialMg = materialDiffereceMidGame(pos);
+  me.materialEg = materialDiffereceEndGame(pos);
+  me.bishopPair = bishopPairDiff(pos);
+  me.kingDistanceMaterial = kingDistanceMaterial(pos);
+  me.route      = endgameRoute(pos, me.ed);
+}
+
+// --- Static eval cache ------------------------------------------------------
+//
+// Quiescence evaluates every node for stand-pat, and transpositions bring the
+// same positions back moments later. The evaluation is a pure function of the
+// position (hashValue covers side to move, castling and en passant), so a
+// direct-mapped cache of scores is exact up to hash collisions. The index uses
+// the low 16 bits of the key and the check the high 32.
+//
+// The cache also outlives searches on the thread that ran them -- the CLI
+// runs search() on its own thread, and the UCI thread may evaluate between
+// options -- so it is tagged with nnue::generation(), which moves whenever a
+// network is loaded or dropped or UseNNUE is toggled, and cleared on a change.
+
+struct EvalCacheEntry
+{
+  uint32_t keyCheck;
+  Score    score;
+};
+
+constexpr size_t EVAL_CACHE_SIZE = 1 << 16;
+
+// --- Per-thread tables -------------------------------------------------------
+//
+// The hash tables above, one set per thread so entries are never torn by a
+// concurrent write. Heap-allocated on the thread's first evaluation and freed
+// when it exits: at 1.6 MB they do not belong in the TLS block every thread
+// (search helpers included) gets at spawn, for the reason the search history
+// is not there either (see clearHistory). Value-initialised; a zeroed pawn
+// entry is already correct for key 0 (no pawns on the board), every term 0,
+// and materialKey counts the kings, so it is never 0 and a zeroed material
+// entry never matches.
+
+struct EvalTables
+{
+  array<PawnEntry, PAWN_TABLE_SIZE> pawns;
+  array<MaterialEntry, MATERIAL_TABLE_SIZE> material;
+  array<EvalCacheEntry, EVAL_CACHE_SIZE> cache;
+  uint32_t cacheGeneration;
+};
+
+static constinit thread_local EvalTables* evalTables = nullptr;
+
+// Owns *evalTables.
+static constinit thread_local std::unique_ptr<EvalTables> evalTablesStorage;
+
+static constinit thread_local EvalCacheStats evalCacheCounters;
+
+static EvalTables&
+threadEvalTables()
+{
+  if (!evalTables)
+  {
+    evalTablesStorage = std::make_unique<EvalTables>();
+    evalTables = evalTablesStorage.get();
+  }
+
+  return *evalTables;
+}
+
+static const PawnEntry&
+probePawnEntry(const ChessBoard& pos)
+{
+  PawnEntry& pe = threadEvalTables().pawns[pos.pawnKey & (PAWN_TABLE_SIZE - 1)];
+  if (pe.key != pos.pawnKey)
+    computePawnEntry(pos, pe);
+  return pe;
+}
+
+static const MaterialEntry&
+probeMaterialEntry(const ChessBoard& pos)
+{
+  // The key is a packed count, not a random hash: mix it before indexing.
+  const size_t index = size_t((pos.materialKey * 0x9E3779B97F4A7C15ULL) >> (64 - MATERIAL_TABLE_BITS));
+  MaterialEntry& me = threadEvalTables().material[index];
+
+  if (me.key != pos.materialKey)
+    computeMaterialEntry(pos, me);
+  return me;
+}
+
+// The thread's eval cache, emptied first if the evaluation changed since it
+// was filled.
+static array<EvalCacheEntry, EVAL_CACHE_SIZE>&
+threadEvalCache()
+{
+  EvalTables& tables = threadEvalTables();
+
+  if (tables.cacheGeneration != nnue::generation())
   {
-    if ((pieceCount == 2) and
-        (pos.count<PAWN  >() == 1) and
-        (pos.count<BISHOP>() == 1 or pos.count<KNIGHT>() == 1) and
-        (pos.count<WHITE, ALL>() == 1)
-    ) return minorPiecePawnEndgame(pos) * side2move;
+    tables.cache.fill(EvalCacheEntry{});
+    tables.cacheGeneration = nnue::generation();
   }
 
+  return tables.cache;
+}
+
+EvalCacheStats&
+evalCacheStats()
+{ return evalCacheCounters; }
+
+template <bool debug>
+static Score
+evaluatePosition(const ChessBoard& pos, AttackInfo& attacks)
+{
+  const MaterialEntry& me = probeMaterialEntry(pos);
+  int side2move = 2 * int(pos.color) - 1;
+  float phase = me.ed.phase;
+
+  if (me.route == EndgameRoute::MINOR_PIECE_PAWN)
+    return minorPiecePawnEndgame(pos) * side2move;
+
   if (debug)
   {
     cout << "----------------------------------------------" << endl;
-    cout << "BoardWeight = " << ed.boardWeight << endl;
+    cout << "BoardWeight = " << me.ed.boardWeight << endl;
     cout << "Phase = " << phase << endl;
   }
 
   // Special Piece EndGames
-  if ((pos.count<PAWN>() == 0) and (ed.pieces[WHITE] == 0 or ed.pieces[BLACK] == 0))
+  if (me.route == EndgameRoute::LONE_KING_WHITE)
+    return loneKingEndGame<WHITE, debug>(pos) * side2move;
+
+  if (me.route == EndgameRoute::LONE_KING_BLACK)
+    return loneKingEndGame<BLACK, debug>(pos) * side2move;
+
+  // The recognisers above stay in front of the network: they encode exact
+  // endgame knowledge a small net can only approximate.
+  if (nnue::enabled())
   {
-    Score score = (ed.pieces[WHITE] > 0) ? loneKingEndGame<WHITE, debug>(pos) : loneKingEndGame<BLACK, debug>(pos);
-    return score * side2move;
+    Score score = nnue::evaluate(pos);
+
+    if (debug)
+    {
+      cout << "nnue     = " << score
+           << " (from scratch " << nnue::evaluateFromScratch(pos) << ")" << endl;
+      cout << "----------------------------------------------" << endl;
+    }
+
+    return score;
   }
 
-  Score mgScore = midGameScore<debug>(pos, phase);
-  Score egScore = endGameScore<debug>(pos, ed, 1 - phase);
+  const PawnEntry& pe = probePawnEntry(pos);
+  attacks.fill(pos);
+
+  Score mgScore = midGameScore<debug>(pos, me, pe, attacks);
+  Score egScore = endGameScore<debug>(pos, me, pe);
 
   Score score = Score( phase * float(mgScore) + (1 - phase) * float(egScore) );
 
@@ -725,9 +906,43 @@ evaluate(const ChessBoard& pos)
 }
 
 
-template Score threats<false>(const ChessBoard& pos);
-template Score threats<true >(const ChessBoard& pos);
+template Score threats<false>(const ChessBoard& pos, const AttackInfo& attacks);
+template Score threats<true >(const ChessBoard& pos, const AttackInfo& attacks);
+
+template <bool debug>
+Score
+evaluate(const ChessBoard& pos, AttackInfo& attacks)
+{
+  // The debug breakdown always recomputes.
+  if constexpr (debug)
+    return evaluatePosition<true>(pos, attacks);
+
+  EvalCacheEntry& entry = threadEvalCache()[pos.hashValue & (EVAL_CACHE_SIZE - 1)];
+  const uint32_t keyCheck = uint32_t(pos.hashValue >> 32);
+
+  evalCacheCounters.probes++;
+  if (entry.keyCheck == keyCheck)
+  {
+    evalCacheCounters.hits++;
+    return entry.score;
+  }
+
+  const Score score = evaluatePosition<false>(pos, attacks);
+  entry = EvalCacheEntry{ keyCheck, score };
+  return score;
+}
+
+template <bool debug>
+Score
+evaluate(const ChessBoard& pos)
+{
+  AttackInfo attacks;
+  return evaluate<debug>(pos, attacks);
+}
+
 
+template Score evaluate<false>(const ChessBoard& pos, AttackInfo& attacks);
+template Score evaluate<true >(const ChessBoard& pos, AttackInfo& attacks);
 template Score evaluate<false>(const ChessBoard& pos);
 template Score evaluate<true >(const ChessBoard& pos);
 
@@ -758,7 +973,14 @@ extractEvalComponents(const ChessBoard& pos)
   ec.tunable = true;
   ec.phase   = phase;
 
-  MobilityDiffs mob = mobilityDiffs(pos);
+  AttackInfo attacks;
+  attacks.fill(pos);
+  MobilityDiffs mob = mobilityDiffs(attacks);
+
+  // Computed fresh, not probed: the tuner walks millions of distinct positions
+  // once each, and must not depend on (or pollute) the search's pawn table.
+  PawnEntry pe;
+  computePawnEntry(pos, pe);
 
   ec.matMg     = float(materialDiffereceMidGame(pos));
   ec.ptMg      = float(pieceTableStrengthMidGame(pos));
@@ -766,19 +988,18 @@ extractEvalComponents(const ChessBoard& pos)
   ec.mobKnight = mob.knight;
   ec.mobRook   = mob.rook;
   ec.mobQueen  = mob.queen;
-  ec.pawnMg    = float(pawnStructureScoreMidgame<WHITE>(pos)
-               - pawnStructureScoreMidgame<BLACK>(pos));
-  ec.threats   = float(threats<false>(pos));
+  ec.pawnMg    = float(pe.doubledMg[WHITE] - pe.doubledMg[BLACK]);
+  ec.threats   = float(threats<false>(pos, attacks));
 
   ec.matEg    = float(materialDiffereceEndGame(pos));
   ec.ptEg     = float(pieceTableStrengthEndGame(pos));
-  ec.pawnEg   = float(pawnStructureScoreEndgame<WHITE>(pos, ed)
-              - pawnStructureScoreEndgame<BLACK>(pos, ed));
+  ec.pawnEg   = float(pawnStructureScoreEndgame<WHITE>(pos, ed, pe)
+              - pawnStructureScoreEndgame<BLACK>(pos, ed, pe));
   ec.distance = float(distanceBetweenKingsScore(pos));
 
   ec.bishopPair = float(bishopPairDiff(pos));
   ec.rookFileMg = float(rookFileUnits<WHITE>(pos) - rookFileUnits<BLACK>(pos));
-  ec.isolated   = float(isolatedPawnCount<WHITE>(pos) - isolatedPawnCount<BLACK>(pos));
+  ec.isolated   = float(pe.isolated[WHITE] - pe.isolated[BLACK]);
 
   return ec;
 }
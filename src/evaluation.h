@@ -2,6 +2,7 @@
 #ifndef EVALUATION_H
 #define EVALUATION_H
 
+#include "attacks.h"
 #include "bitboard.h"
 #include "PieceSquareTable.h"
 
@@ -23,10 +24,12 @@ class EvalData
 
 	public:
 
-	int  pieces[COLOR_NB];
+	int  pieces[COLOR_NB] = {};
 
-	int boardWeight;
-	float phase;
+	int boardWeight = 0;
+	float phase = 0;
+
+	EvalData() = default;
 
 	EvalData(const ChessBoard& pos)
 	{
@@ -84,12 +87,29 @@ extern EvalWeights evalWeights;
 
 template <bool debug=false>
 Score
-threats(const ChessBoard& pos);
+threats(const ChessBoard& pos, const AttackInfo& attacks);
 
+// Side-to-move relative static evaluation. The non-debug form is served from a
+// per-thread direct-mapped cache keyed by the position hash.
 template <bool debug=false>
 Score
 evaluate(const ChessBoard& pos);
 
+// Same, reusing the node's attack sets: a cache miss fills the sides `attacks`
+// does not have yet and reads the rest as they are.
+template <bool debug=false>
+Score
+evaluate(const ChessBoard& pos, AttackInfo& attacks);
+
+// Static-eval cache counters for the calling thread, accumulated until reset.
+struct EvalCacheStats
+{
+	uint64_t probes = 0, hits = 0;
+};
+
+EvalCacheStats&
+evalCacheStats();
+
 
 // White-relative per-component eval subtotals for one position, cached by the Texel
 // tuner so each iteration is pure arithmetic (no board/movegen). The blend is linear
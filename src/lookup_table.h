@@ -6,6 +6,17 @@
 #include "types.h"
 #include <array>
 
+// Slider attack tables are indexed with BMI2 PEXT when the target has it
+// (-march=native on a BMI2 host defines __BMI2__), and by magic multiply-shift
+// otherwise. `make elsa PEXT=0` forces magics, for CPUs where PEXT is
+// microcoded and slow (AMD before Zen 3) and to compare the two builds.
+#if defined(__BMI2__) && !defined(NO_PEXT)
+#define USE_PEXT 1
+#include <immintrin.h>
+#else
+#define USE_PEXT 0
+#endif
+
 using std::array;
 using MaskTable  = array<Bitboard, SQUARE_NB>;
 using ShiftTable = array<int     , SQUARE_NB>;
@@ -52,6 +63,24 @@ namespace plt
   void
   init();
 
+  // Slot of `occupied` in one square's slice of a slider lookup table. PEXT
+  // packs the relevant occupancy bits densely, so the slice holds exactly
+  // 2^popcount(mask) entries; the magic multiply-shift scatters them into a
+  // slice sized by `shift`. The builder and attackSquares both go through
+  // here, so the two can never disagree on the layout.
+  inline uint64_t
+  slidingIndex(Bitboard occupied, Bitboard mask, [[maybe_unused]] uint64_t magic,
+               [[maybe_unused]] int shift) noexcept
+  {
+#if USE_PEXT
+    return _pext_u64(occupied, mask);
+#else
+    return (magic * (occupied & mask)) >> shift;
+#endif
+  }
+
+  inline constexpr const char* slidingIndexName = USE_PEXT ? "pext" : "magic";
+
 
   // Square-to-square distance tables. 4 KB each, and constexpr rather than
   // built in init(), so they are plain .rodata and carry no dependency on
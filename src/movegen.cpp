@@ -165,7 +165,7 @@ isLegalMoveForPosition_V2_impl(Move move, const ChessBoard& pos)
       constexpr Square   kingHome  = Square(shift + 4);
 
       if (ip != kingHome) return false;
-      if (squareAttacked(ip, occ)) return false;
+      if (pos.checkInfo().checkers) return false;
 
       bool isKingside  = (fp == Square(shift + 6));
       bool isQueenside = (fp == Square(shift + 2));
@@ -217,6 +217,12 @@ isLegalMoveForPosition_V2_impl(Move move, const ChessBoard& pos)
     }
   }
 
+  // Out of check, a piece that shields nothing from the king cannot expose
+  // it. En passant lifts a second pawn, so it takes the full test below.
+  const CheckInfo& ci = pos.checkInfo();
+  if (pt != KING and epCapturedSq == SQUARE_NB and ci.checkers == 0 and (ci.pinned & fromBb) == 0)
+    return true;
+
   Square kSq = (pt == KING) ? fp : squareNo(pos.piece<cMy, KING>());
 
   if (attackSquares<KNIGHT>(kSq, occAfter) & eKnight) return false;
@@ -311,7 +317,7 @@ promotionPawns(const ChessBoard& pos, MoveList &myMoves, Bitboard moveSq, Bitboa
 }
 
 
-template <Color cMy, ShifterFunc shift>
+template <Color cMy, ShifterFunc shift, bool capturesOnly>
 static inline void
 pawnMovement(const ChessBoard& pos, MoveList &myMoves)
 {
@@ -333,7 +339,7 @@ pawnMovement(const ChessBoard& pos, MoveList &myMoves)
   Bitboard freeSq = ~pos.all();
   Bitboard enemyP  = pos.piece< ~cMy, ALL>();
   Bitboard captSq = (atkArea &  enemyP) * (KA) + (enemyP) * (1 - KA);
-  Bitboard moveSq = (atkArea ^  captSq) * (KA) + (freeSq) * (1 - KA);
+  Bitboard moveSq = capturesOnly ? 0 : (atkArea ^  captSq) * (KA) + (freeSq) * (1 - KA);
 
   Bitboard lCaptures = shift(lPawns, 7 + 2 * c) & captSq;
   Bitboard rCaptures = shift(rPawns, 7 + 2 * (1 - c)) & captSq;
@@ -344,13 +350,14 @@ pawnMovement(const ChessBoard& pos, MoveList &myMoves)
   myMoves.addPawns(pos, 0, lCaptures);
   myMoves.addPawns(pos, 1, rCaptures);
 
+  // moveSq is empty for a capture-only pass, which clears the push buckets
   myMoves.addPawns(pos, 2, shift(sPawns, 8) & moveSq);
   myMoves.addPawns(pos, 3, shift(pawns , 8) & moveSq);
 }
 
 #endif
 
-template <Color cMy, BitboardFunc bitboardFunc, const MaskTable& maskTable, char pawn>
+template <Color cMy, BitboardFunc bitboardFunc, const MaskTable& maskTable, char pawn, bool capturesOnly>
 static Bitboard
 pinsCheck(const ChessBoard& pos, MoveList& myMoves, Bitboard slidingPieceMy, Bitboard slidingPieceEmy)
 {
@@ -375,7 +382,10 @@ pinsCheck(const ChessBoard& pos, MoveList& myMoves, Bitboard slidingPieceMy, Bit
 
   if ((firstPiece & slidingPieceMy) != 0)
   {
-    Bitboard destSq  = maskTable[kpos] ^ maskTable[indexS] ^ firstPiece;
+    // Along the pin line, up to and including the pinner: its square is the
+    // only capture there.
+    Bitboard destSq  = capturesOnly ? secondPiece
+                     : maskTable[kpos] ^ maskTable[indexS] ^ firstPiece;
 
     myMoves.add(pos, indexF, destSq);
     return pinnedPieces;
@@ -391,7 +401,7 @@ pinsCheck(const ChessBoard& pos, MoveList& myMoves, Bitboard slidingPieceMy, Bit
   Bitboard sPawn  = shift(nPawn, 8) & freeSq;
   Bitboard ssPawn = shift(sPawn & Rank63[cMy], 8) & freeSq;
 
-  if ((pawn == 's') and (firstPiece & pos.piece<cMy, PAWN>()))
+  if ((pawn == 's') and !capturesOnly and (firstPiece & pos.piece<cMy, PAWN>()))
     myMoves.add(pos, indexF, sPawn | ssPawn);
 
   if ((pawn == 'c') and (firstPiece & pos.piece<cMy, PAWN>()))
@@ -408,32 +418,31 @@ pinsCheck(const ChessBoard& pos, MoveList& myMoves, Bitboard slidingPieceMy, Bit
   return pinnedPieces;
 }
 
-template <Color cMy>
+template <Color cMy, bool capturesOnly>
 static Bitboard
 pinnedPiecesList(const ChessBoard& pos, MoveList &myMoves)
 {
   constexpr Color cEmy = ~cMy;
-  Square kpos = squareNo( pos.piece<cMy, KING>() );
 
   Bitboard erq = pos.piece<cEmy, QUEEN>() | pos.piece<cEmy, ROOK  >();
   Bitboard ebq = pos.piece<cEmy, QUEEN>() | pos.piece<cEmy, BISHOP>();
   Bitboard  rq = pos.piece<cMy , QUEEN>() | pos.piece<cMy , ROOK  >();
   Bitboard  bq = pos.piece<cMy , QUEEN>() | pos.piece<cMy , BISHOP>();
 
-  if ((  plt::lineMasks[kpos] & erq) == 0 and
-    (plt::diagonalMasks[kpos] & ebq) == 0) return 0ULL;
+  if (pos.checkInfo().pinned == 0)
+    return 0ULL;
 
   Bitboard pinnedPieces = 0;
 
-  pinnedPieces |= pinsCheck<cMy, lsb, plt::rightMasks, '-'>(pos, myMoves, rq, erq);
-  pinnedPieces |= pinsCheck<cMy, msb, plt::leftMasks , '-'>(pos, myMoves, rq, erq);
-  pinnedPieces |= pinsCheck<cMy, lsb, plt::upMasks   , 's'>(pos, myMoves, rq, erq);
-  pinnedPieces |= pinsCheck<cMy, msb, plt::downMasks , 's'>(pos, myMoves, rq, erq);
+  pinnedPieces |= pinsCheck<cMy, lsb, plt::rightMasks, '-', capturesOnly>(pos, myMoves, rq, erq);
+  pinnedPieces |= pinsCheck<cMy, msb, plt::leftMasks , '-', capturesOnly>(pos, myMoves, rq, erq);
+  pinnedPieces |= pinsCheck<cMy, lsb, plt::upMasks   , 's', capturesOnly>(pos, myMoves, rq, erq);
+  pinnedPieces |= pinsCheck<cMy, msb, plt::downMasks , 's', capturesOnly>(pos, myMoves, rq, erq);
 
-  pinnedPieces |= pinsCheck<cMy, lsb, plt::upRightMasks  , 'c'>(pos, myMoves, bq, ebq);
-  pinnedPieces |= pinsCheck<cMy, lsb, plt::upLeftMasks   , 'c'>(pos, myMoves, bq, ebq);
-  pinnedPieces |= pinsCheck<cMy, msb, plt::downRightMasks, 'c'>(pos, myMoves, bq, ebq);
-  pinnedPieces |= pinsCheck<cMy, msb, plt::downLeftMasks , 'c'>(pos, myMoves, bq, ebq);
+  pinnedPieces |= pinsCheck<cMy, lsb, plt::upRightMasks  , 'c', capturesOnly>(pos, myMoves, bq, ebq);
+  pinnedPieces |= pinsCheck<cMy, lsb, plt::upLeftMasks   , 'c', capturesOnly>(pos, myMoves, bq, ebq);
+  pinnedPieces |= pinsCheck<cMy, msb, plt::downRightMasks, 'c', capturesOnly>(pos, myMoves, bq, ebq);
+  pinnedPieces |= pinsCheck<cMy, msb, plt::downLeftMasks , 'c', capturesOnly>(pos, myMoves, bq, ebq);
 
   return pinnedPieces;
 }
@@ -445,12 +454,14 @@ legalSquares(Square sq, Bitboard occupiedMy, Bitboard occupied)
 { return ~occupiedMy & attackSquares<pt>(sq, occupied); }
 
 
-template <Color cMy, PieceType pt, PieceType... rest>
+template <Color cMy, bool capturesOnly, PieceType pt, PieceType... rest>
 static void
 addLegalSquares(const ChessBoard& pos, MoveList& myMoves)
 {
   int KA = myMoves.checkers;
   Bitboard validSquares = KA * myMoves.legalSquaresMaskInCheck + (1 - KA) * AllSquares;
+  if constexpr (capturesOnly)
+    validSquares &= pos.piece<~cMy, ALL>();
   Bitboard ownPieces = pos.piece<  cMy, ALL>();
   Bitboard occupied  = pos.all();
   Bitboard pieceBb   = pos.piece<cMy, pt>() & (~myMoves.pinnedPiecesSquares);
@@ -464,17 +475,22 @@ addLegalSquares(const ChessBoard& pos, MoveList& myMoves)
   }
 
   if constexpr (sizeof...(rest) > 0)
-    addLegalSquares<cMy, rest...>(pos, myMoves);
+    addLegalSquares<cMy, capturesOnly, rest...>(pos, myMoves);
 }
 
-template <Color cMy, ShifterFunc shift>
+/**
+ * @brief Moves of every piece but the king. With capturesOnly, destinations
+ * are limited to enemy pieces (plus en passant) and pawn pushes are skipped,
+ * quiet promotions included.
+**/
+template <Color cMy, ShifterFunc shift, bool capturesOnly>
 static void
 pieceMovement(const ChessBoard& pos, MoveList& myMoves)
 {
-  myMoves.pinnedPiecesSquares  = pinnedPiecesList<cMy>(pos, myMoves);
+  myMoves.pinnedPiecesSquares  = pinnedPiecesList<cMy, capturesOnly>(pos, myMoves);
 
-  pawnMovement<cMy, shift>(pos, myMoves);
-  addLegalSquares<cMy, BISHOP, KNIGHT, ROOK, QUEEN>(pos, myMoves);
+  pawnMovement<cMy, shift, capturesOnly>(pos, myMoves);
+  addLegalSquares<cMy, capturesOnly, BISHOP, KNIGHT, ROOK, QUEEN>(pos, myMoves);
 }
 
 #endif
@@ -497,68 +513,56 @@ attackedSquaresGen(const ChessBoard& pos, Bitboard occupied)
   return squares;
 }
 
-template <Color side>
-static Bitboard
-generateAttackedSquares(const ChessBoard& pos, Bitboard occupied)
-{
-  return pawnAttackSquares<side>(pos)
-      | attackedSquaresGen<side, BISHOP, KNIGHT, ROOK, QUEEN, KING>(pos, occupied);
-}
-
 
-template <Color cMy, PieceType pt, PieceType emy>
-static void
-addAttacker(const ChessBoard& pos, int& attackerCount, Bitboard& attackedMask)
+// Squares the enemy attacks with our king lifted off the board, so the king
+// cannot step back along the line of a slider checking it. Only a checking
+// slider sees further than in `attacks`, so the rest is reused as is.
+template <Color cMy>
+static Bitboard
+enemyAttackedSquares(const ChessBoard& pos, const AttackInfo& attacks)
 {
-  Square kSq = squareNo(pos.piece<cMy, KING>());
-  Bitboard occupied = pos.all();
-  Bitboard enemyBb = pos.piece<~cMy, pt>() | pos.piece<~cMy, emy>();
-
-  Bitboard kingMask  = attackSquares<pt>(kSq, occupied);
-  Bitboard pieceMask = kingMask & enemyBb;
-
-  if (pieceMask == 0)
-    return;
+  constexpr Color cEmy = ~cMy;
+  const auto& emy = attacks.byType[cEmy];
 
-  if ((pieceMask & (pieceMask - 1)) != 0)
-    ++attackerCount;
+  if (((emy[BISHOP] | emy[ROOK] | emy[QUEEN]) & pos.piece<cMy, KING>()) == 0)
+    return emy[ALL];
 
-  ++attackerCount;
-  attackedMask |= (kingMask & attackSquares<pt>(squareNo(pieceMask), occupied)) | pieceMask;
+  return emy[ALL]
+    | attackedSquaresGen<cEmy, BISHOP, ROOK, QUEEN>(pos, pos.all() ^ pos.piece<cMy, KING>());
 }
 
-
+// Checker count and, for a single check, the squares that answer it: the
+// checker itself or, for a slider, any square in between.
 template <Color cMy>
 static void
 kingAttackers(const ChessBoard& pos, MoveList& myMoves)
 {
-  Bitboard attackedSq = myMoves.enemyAttackedSquares;
-  constexpr Color cEmy = ~cMy;
+  Bitboard checkers = pos.checkInfo().checkers;
 
-  if (attackedSq && ((pos.piece<cMy, KING>() & attackedSq)) == 0)
+  if (checkers == 0)
     return;
 
   Square kpos = squareNo(pos.piece<cMy, KING>());
+  Bitboard occupied = pos.all();
+  Bitboard attackedMask = checkers;
 
-  int attackerCount = 0;
-  Bitboard attackedMask = 0;
-
-  addAttacker<cMy, ROOK  , QUEEN>(pos, attackerCount, attackedMask);
-  addAttacker<cMy, BISHOP, QUEEN>(pos, attackerCount, attackedMask);
-  addAttacker<cMy, KNIGHT, NONE >(pos, attackerCount, attackedMask);
+  myMoves.checkers = popCount(checkers);
 
-  Bitboard pawnSq = plt::pawnCaptureMasks[cMy][kpos] & pos.piece<cEmy, PAWN>();
-  if (pawnSq != 0)
+  while (checkers != 0)
   {
-    ++attackerCount;
-    attackedMask |= pawnSq;
+    Square sq = nextSquare(checkers);
+    PieceType pt = type_of(pos.pieceOnSquare(sq));
+
+    if (pt == ROOK or (pt == QUEEN and (plt::lineMasks[kpos] & (1ULL << sq))))
+      attackedMask |= attackSquares<ROOK>(kpos, occupied) & attackSquares<ROOK>(sq, occupied);
+    else if (pt == BISHOP or pt == QUEEN)
+      attackedMask |= attackSquares<BISHOP>(kpos, occupied) & attackSquares<BISHOP>(sq, occupied);
   }
 
-  myMoves.checkers = attackerCount;
   myMoves.legalSquaresMaskInCheck = attackedMask;
 }
 
-template <Color cMy>
+template <Color cMy, bool noCastling>
 static void
 kingMoves(const ChessBoard& pos, MoveList& myMoves)
 {
@@ -571,7 +575,7 @@ kingMoves(const ChessBoard& pos, MoveList& myMoves)
 
   myMoves.add(pos, kpos, destSq);
 
-  if (!(pos.csep & 1920) or ((1ULL << kpos) & attackedSq)) {
+  if (noCastling or !(pos.csep & 1920) or ((1ULL << kpos) & attackedSq)) {
     // no castling move available, thus early exit
     return;
   }
@@ -678,25 +682,39 @@ generateSquaresThatCheckEnemyKing(const ChessBoard& pos, MoveList& myMoves)
 }
 
 template <MoveGenStage stage, Color cMy>
-static inline void
-stagedGenerateMovesImpl(const ChessBoard& pos, MoveList& myMoves)
+void
+stagedGenerateMoves(const ChessBoard& pos, MoveList& myMoves)
 {
   if constexpr (stage == GEN_METADATA)
   {
     myMoves.color = cMy;
     myMoves.myPawns = pos.piece<cMy, PAWN>();
-    myMoves.enemyAttackedSquares = generateAttackedSquares<~cMy>(pos, pos.all() ^ pos.piece<cMy, KING>());
+    myMoves.attacks.fill<~cMy>(pos);
+    myMoves.enemyAttackedSquares = enemyAttackedSquares<cMy>(pos, myMoves.attacks);
 
     kingAttackers<cMy>(pos, myMoves);
   }
-  else if constexpr (stage == GEN_MOVES)
+  else if constexpr (stage == GEN_MOVES or stage == GEN_EVASIONS)
+  {
+    constexpr ShifterFunc shift = (cMy == WHITE) ? leftShift : rightShift;
+
+    if (myMoves.checkers < 2)
+      pieceMovement<cMy, shift, false>(pos, myMoves);
+
+    // In check castling is illegal anyway; the evasion stage skips the test.
+    kingMoves<cMy, stage == GEN_EVASIONS>(pos, myMoves);
+  }
+  else if constexpr (stage == GEN_CAPTURES)
   {
     constexpr ShifterFunc shift = (cMy == WHITE) ? leftShift : rightShift;
 
     if (myMoves.checkers < 2)
-      pieceMovement<cMy, shift>(pos, myMoves);
+      pieceMovement<cMy, shift, true>(pos, myMoves);
 
-    kingMoves<cMy>(pos, myMoves);
+    // Every safe king step, quiet ones included: getMoves<CAPTURES> ignores
+    // them, but they let anyMove() rule out stalemate without a quiet pass in
+    // all but a few positions.
+    kingMoves<cMy, true>(pos, myMoves);
   }
   else if constexpr (stage == GEN_CHECKS)
   {
@@ -711,29 +729,79 @@ void
 stagedGenerateMoves(const ChessBoard& pos, MoveList& myMoves)
 {
   pos.color == WHITE
-    ? stagedGenerateMovesImpl<stage, WHITE>(pos, myMoves)
-    : stagedGenerateMovesImpl<stage, BLACK>(pos, myMoves);
+    ? stagedGenerateMoves<stage, WHITE>(pos, myMoves)
+    : stagedGenerateMoves<stage, BLACK>(pos, myMoves);
 }
 
 template void stagedGenerateMoves<GEN_METADATA>(const ChessBoard&, MoveList&);
 template void stagedGenerateMoves<GEN_MOVES   >(const ChessBoard&, MoveList&);
 template void stagedGenerateMoves<GEN_CHECKS  >(const ChessBoard&, MoveList&);
+template void stagedGenerateMoves<GEN_CAPTURES>(const ChessBoard&, MoveList&);
+template void stagedGenerateMoves<GEN_EVASIONS>(const ChessBoard&, MoveList&);
+
+template void stagedGenerateMoves<GEN_METADATA, WHITE>(const ChessBoard&, MoveList&);
+template void stagedGenerateMoves<GEN_MOVES   , WHITE>(const ChessBoard&, MoveList&);
+template void stagedGenerateMoves<GEN_CHECKS  , WHITE>(const ChessBoard&, MoveList&);
+template void stagedGenerateMoves<GEN_CAPTURES, WHITE>(const ChessBoard&, MoveList&);
+template void stagedGenerateMoves<GEN_EVASIONS, WHITE>(const ChessBoard&, MoveList&);
+template void stagedGenerateMoves<GEN_METADATA, BLACK>(const ChessBoard&, MoveList&);
+template void stagedGenerateMoves<GEN_MOVES   , BLACK>(const ChessBoard&, MoveList&);
+template void stagedGenerateMoves<GEN_CHECKS  , BLACK>(const ChessBoard&, MoveList&);
+template void stagedGenerateMoves<GEN_CAPTURES, BLACK>(const ChessBoard&, MoveList&);
+template void stagedGenerateMoves<GEN_EVASIONS, BLACK>(const ChessBoard&, MoveList&);
 
 
+template <Color cMy>
 MoveList
 generateMoves(const ChessBoard& pos, bool generateChecksData)
 {
   MoveList myMoves;
 
-  stagedGenerateMoves<GEN_METADATA>(pos, myMoves);
-  stagedGenerateMoves<GEN_MOVES>(pos, myMoves);
+  stagedGenerateMoves<GEN_METADATA, cMy>(pos, myMoves);
+  stagedGenerateMoves<GEN_MOVES   , cMy>(pos, myMoves);
 
   if (generateChecksData)
-    stagedGenerateMoves<GEN_CHECKS>(pos, myMoves);
+    stagedGenerateMoves<GEN_CHECKS, cMy>(pos, myMoves);
 
   return myMoves;
 }
 
+MoveList
+generateMoves(const ChessBoard& pos, bool generateChecksData)
+{
+  return pos.color == WHITE
+    ? generateMoves<WHITE>(pos, generateChecksData)
+    : generateMoves<BLACK>(pos, generateChecksData);
+}
+
+template <Color cMy>
+MoveList
+generateCaptures(const ChessBoard& pos)
+{
+  MoveList myMoves;
+
+  stagedGenerateMoves<GEN_METADATA, cMy>(pos, myMoves);
+
+  myMoves.checkers
+    ? stagedGenerateMoves<GEN_EVASIONS, cMy>(pos, myMoves)
+    : stagedGenerateMoves<GEN_CAPTURES, cMy>(pos, myMoves);
+
+  return myMoves;
+}
+
+MoveList
+generateCaptures(const ChessBoard& pos)
+{
+  return pos.color == WHITE
+    ? generateCaptures<WHITE>(pos)
+    : generateCaptures<BLACK>(pos);
+}
+
+template MoveList generateMoves<WHITE>(const ChessBoard&, bool);
+template MoveList generateMoves<BLACK>(const ChessBoard&, bool);
+template MoveList generateCaptures<WHITE>(const ChessBoard&);
+template MoveList generateCaptures<BLACK>(const ChessBoard&);
+
 
 template<Color cMy, PieceType pt, PieceType... rest>
 Square
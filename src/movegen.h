@@ -47,6 +47,14 @@ template <MoveGenStage stage>
 void
 stagedGenerateMoves(const ChessBoard& pos, MoveList& myMoves);
 
+// The generators below also come with the side to move as a template
+// parameter, which must match pos.color. The untemplated ones test pos.color
+// once and forward; the search, which knows the side at every ply, calls
+// these directly so the colour tests fold away.
+template <MoveGenStage stage, Color cMy>
+void
+stagedGenerateMoves(const ChessBoard& pos, MoveList& myMoves);
+
 /**
  * @brief Returns a list of all the legal moves in current position.
  *
@@ -58,6 +66,26 @@ stagedGenerateMoves(const ChessBoard& pos, MoveList& myMoves);
 MoveList
 generateMoves(const ChessBoard& pos, bool generateChecksData=false);
 
+template <Color cMy>
+MoveList
+generateMoves(const ChessBoard& pos, bool generateChecksData=false);
+
+/**
+ * @brief Returns the moves quiescence searches: captures only, or every
+ * evasion when the side to move is in check.
+ *
+ * Quiet moves other than king steps are not generated, so a list with no
+ * move in it is not yet proof of stalemate; run GEN_MOVES on it to be sure.
+ *
+ * @param pos ChessBoard
+ */
+MoveList
+generateCaptures(const ChessBoard& pos);
+
+template <Color cMy>
+MoveList
+generateCaptures(const ChessBoard& pos);
+
 bool
 pieceTrapped(const ChessBoard& pos, Bitboard myAttackedBB, Bitboard enemyAttackedBB);
 
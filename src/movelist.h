@@ -3,6 +3,7 @@
 #define MOVE_LIST_H
 
 #include "varray.h"
+#include "attacks.h"
 #include "bitboard.h"
 
 using MoveArray = Varray<Move, MAX_MOVES>;
@@ -33,9 +34,9 @@ public:
   Move promoSuppress;
 
   // Number of times removeMove has been called with effect on this list.
-  // Used as the moveNo bias inside playSubsetMoves so LMR's `moveNo <
-  // LMR_LIMIT` gate accounts for moves searched outside the playAllMoves
-  // loop (i.e. the hash-move fast path).
+  // Used as the moveNo bias inside playPickedMoves so LMR's `moveNo <
+  // LMR_LIMIT` gate accounts for moves searched outside the move picker
+  // (i.e. the hash-move fast path).
   uint16_t removedMovesCount;
 
   // Array to store squares that give check to the enemy king
@@ -60,6 +61,10 @@ public:
   // Bitboard representing squares under enemy attack
   Bitboard enemyAttackedSquares;
 
+  // The node's attack sets. GEN_METADATA fills the enemy side; evaluate()
+  // and SEE reuse it instead of recomputing.
+  AttackInfo attacks;
+
   MoveList()
   : checkers(0), initSquares(0), enpassantPawns(0),
     promoSuppress(0), removedMovesCount(0), myAttackedSquares(0) {}
@@ -0,0 +1,500 @@
+
+
+#include "nnue.h"
+#include "bitboard.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace nnue
+{
+
+bool netLoaded = false;
+bool useNnue = true;
+
+namespace
+{
+
+// See generation().
+uint32_t evalGeneration = 1;
+
+constexpr int QA = 255;
+constexpr int QB = 64;
+constexpr int SCALE = 400;
+
+constexpr uint32_t FILE_VERSION = 1;
+constexpr char FILE_MAGIC[8] = { 'E', 'L', 'S', 'A', 'N', 'N', 'U', 'E' };
+
+// One entry per undo-stack slot, plus the root.
+constexpr int STACK_SIZE = MAX_MOVES + 1;
+
+struct Network
+{
+  std::vector<int16_t> featureWeights;   // [INPUTS][L1]
+  std::vector<int16_t> featureBias;      // [L1]
+  std::vector<int16_t> outputWeights;    // [2 * L1], side to move first
+  int32_t outputBias = 0;
+};
+
+Network net;
+std::string netPath;
+
+// Bumped on every load. Accumulators carry the epoch they were computed
+// under, so a stack entry left over from the previous network never matches.
+uint32_t netEpoch = 1;
+
+struct alignas(64) Accumulator
+{
+  int16_t values[COLOR_NB][L1];
+  Key      key;
+  uint32_t epoch;
+  bool     computed[COLOR_NB];
+};
+
+// The pieces one move changed. A capture, a promotion and a castling rook
+// each add an entry, so three is the most any move needs (capture-promotion).
+// `parentKey` and `move` identify the move this entry was recorded for; an
+// entry whose pair no longer matches the board's undo stack is stale.
+struct DirtyPiece
+{
+  Key    parentKey;
+  Move   move;
+  int    count;
+  Piece  piece[3];
+  Square from[3];   // SQUARE_NB: the piece appears (promotion)
+  Square to[3];     // SQUARE_NB: the piece disappears (capture)
+};
+
+struct AccumulatorStack
+{
+  Accumulator acc[STACK_SIZE];
+  DirtyPiece  dirty[STACK_SIZE];
+};
+
+// Per search thread, like the PV and killer tables. At ~280 KB it is kept off
+// TLS, which every thread would otherwise carry whether or not a network is
+// loaded; a thread allocates it the first time it needs an accumulator.
+// make_unique value-initialises it, so every accumulator starts zeroed.
+constinit thread_local AccumulatorStack* accStack = nullptr;
+
+// Owns *accStack.
+constinit thread_local std::unique_ptr<AccumulatorStack> accStackStorage;
+
+AccumulatorStack&
+threadAccStack()
+{
+  if (!accStack)
+  {
+    accStackStorage = std::make_unique<AccumulatorStack>();
+    accStack = accStackStorage.get();
+  }
+
+  return *accStack;
+}
+
+
+// --- Kernels -----------------------------------------------------------------
+
+inline void
+addRow(int16_t* acc, const int16_t* row) noexcept
+{
+#if defined(__AVX2__)
+  for (int i = 0; i < L1; i += 16)
+  {
+    __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i));
+    __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(acc + i), _mm256_add_epi16(a, w));
+  }
+#elif defined(__SSE2__)
+  for (int i = 0; i < L1; i += 8)
+  {
+    __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + i));
+    __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+    _mm_store_si128(reinterpret_cast<__m128i*>(acc + i), _mm_add_epi16(a, w));
+  }
+#else
+  for (int i = 0; i < L1; i++)
+    acc[i] = int16_t(acc[i] + row[i]);
+#endif
+}
+
+inline void
+subRow(int16_t* acc, const int16_t* row) noexcept
+{
+#if defined(__AVX2__)
+  for (int i = 0; i < L1; i += 16)
+  {
+    __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i));
+    __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(acc + i), _mm256_sub_epi16(a, w));
+  }
+#elif defined(__SSE2__)
+  for (int i = 0; i < L1; i += 8)
+  {
+    __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + i));
+    __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+    _mm_store_si128(reinterpret_cast<__m128i*>(acc + i), _mm_sub_epi16(a, w));
+  }
+#else
+  for (int i = 0; i < L1; i++)
+    acc[i] = int16_t(acc[i] - row[i]);
+#endif
+}
+
+// sum(clamp(acc[i], 0, QA) * w[i]). Each product is at most 255 * 32767 and
+// madd pairs them, so an int32 lane holds all L1 / 16 of its partial sums.
+inline int32_t
+clippedDot(const int16_t* acc, const int16_t* w) noexcept
+{
+#if defined(__AVX2__)
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i qa   = _mm256_set1_epi16(QA);
+  __m256i sum = _mm256_setzero_si256();
+
+  for (int i = 0; i < L1; i += 16)
+  {
+    __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+    a = _mm256_min_epi16(_mm256_max_epi16(a, zero), qa);
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, b));
+  }
+
+  __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+  return _mm_cvtsi128_si32(s);
+#elif defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i qa   = _mm_set1_epi16(QA);
+  __m128i sum = _mm_setzero_si128();
+
+  for (int i = 0; i < L1; i += 8)
+  {
+    __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i));
+    a = _mm_min_epi16(_mm_max_epi16(a, zero), qa);
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(a, b));
+  }
+
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+  return _mm_cvtsi128_si32(sum);
+#else
+  int32_t sum = 0;
+  for (int i = 0; i < L1; i++)
+    sum += int32_t(std::clamp<int16_t>(acc[i], 0, QA)) * w[i];
+  return sum;
+#endif
+}
+
+
+// --- Features ----------------------------------------------------------------
+
+// Each perspective sees itself as White: Black's board is flipped vertically.
+inline int
+orient(Color perspective, Square sq) noexcept
+{ return perspective == WHITE ? int(sq) : int(sq) ^ 56; }
+
+inline int
+featureIndex(Color perspective, Square kingSq, Piece pc, Square sq) noexcept
+{
+  const int relColor = color_of(pc) == perspective ? 0 : 1;
+  const int pieceIdx = (type_of(pc) - PAWN) + 5 * relColor;
+  return orient(perspective, kingSq) * 640 + pieceIdx * 64 + orient(perspective, sq);
+}
+
+inline const int16_t*
+featureRow(int index) noexcept
+{ return net.featureWeights.data() + size_t(index) * L1; }
+
+inline Square
+kingSquare(const ChessBoard& pos, Color c) noexcept
+{ return Square(lsbIndex(pos.getPiece(c, KING))); }
+
+void
+refresh(const ChessBoard& pos, int16_t* values, Color perspective) noexcept
+{
+  std::memcpy(values, net.featureBias.data(), sizeof(int16_t) * L1);
+
+  const Square kingSq = kingSquare(pos, perspective);
+  Bitboard pieces = pos.all() ^ pos.getPiece(WHITE, KING) ^ pos.getPiece(BLACK, KING);
+
+  while (pieces)
+  {
+    const Square sq = Square(lsbIndex(pieces));
+    pieces &= pieces - 1;
+    addRow(values, featureRow(featureIndex(perspective, kingSq, pos.pieceOnSquare(sq), sq)));
+  }
+}
+
+// Mark `acc` as holding `perspective`'s half for the position `key`.
+inline void
+tag(Accumulator& acc, Key key, Color perspective) noexcept
+{
+  if (acc.key != key or acc.epoch != netEpoch)
+  {
+    acc.key = key;
+    acc.epoch = netEpoch;
+    acc.computed[WHITE] = acc.computed[BLACK] = false;
+  }
+  acc.computed[perspective] = true;
+}
+
+inline bool
+isValid(const Accumulator& acc, Key key, Color perspective) noexcept
+{ return acc.key == key and acc.epoch == netEpoch and acc.computed[perspective]; }
+
+inline bool
+movesKing(const DirtyPiece& dp, Color perspective) noexcept
+{
+  for (int i = 0; i < dp.count; i++)
+    if (dp.piece[i] == make_piece(perspective, KING))
+      return true;
+  return false;
+}
+
+// Bring the accumulator at the board's current stack depth up to date for one
+// perspective: walk back to the nearest valid ancestor, then replay the
+// recorded piece changes forward. Refresh instead when the chain is broken —
+// a stale or missing record, or a move of this perspective's own king.
+void
+update(const ChessBoard& pos, Color perspective) noexcept
+{
+  AccumulatorStack& st = threadAccStack();
+  const int n = pos.plyCount();
+
+  int i = n;
+  while (!isValid(st.acc[i], pos.hashAt(i), perspective))
+  {
+    const DirtyPiece& dp = st.dirty[i];
+
+    if (i == 0 or dp.parentKey != pos.hashAt(i - 1) or dp.move != pos.moveAt(i - 1)
+        or movesKing(dp, perspective))
+    {
+      refresh(pos, st.acc[n].values[perspective], perspective);
+      tag(st.acc[n], pos.hashValue, perspective);
+      return;
+    }
+    i--;
+  }
+
+  const Square kingSq = kingSquare(pos, perspective);
+
+  for (int j = i + 1; j <= n; j++)
+  {
+    const DirtyPiece& dp = st.dirty[j];
+    int16_t* values = st.acc[j].values[perspective];
+
+    std::memcpy(values, st.acc[j - 1].values[perspective], sizeof(int16_t) * L1);
+
+    for (int k = 0; k < dp.count; k++)
+    {
+      // The other side's king is not a feature; our own king's moves never
+      // get here (movesKing above).
+      if (type_of(dp.piece[k]) == KING)
+        continue;
+      if (dp.from[k] != SQUARE_NB)
+        subRow(values, featureRow(featureIndex(perspective, kingSq, dp.piece[k], dp.from[k])));
+      if (dp.to[k] != SQUARE_NB)
+        addRow(values, featureRow(featureIndex(perspective, kingSq, dp.piece[k], dp.to[k])));
+    }
+
+    tag(st.acc[j], pos.hashAt(j), perspective);
+  }
+}
+
+Score
+output(const Accumulator& acc, Color stm) noexcept
+{
+  const int16_t* w = net.outputWeights.data();
+
+  const int64_t sum = int64_t(net.outputBias)
+                    + clippedDot(acc.values[ stm], w)
+                    + clippedDot(acc.values[~stm], w + L1);
+
+  // Keep network output clear of the mate band, whatever the net says.
+  const int64_t score = sum * SCALE / (QA * QB);
+  return Score(std::clamp<int64_t>(score, -(MATE_BOUND - 1), MATE_BOUND - 1));
+}
+
+inline void
+addDirty(DirtyPiece& dp, Piece pc, Square from, Square to) noexcept
+{
+  dp.piece[dp.count] = pc;
+  dp.from[dp.count] = from;
+  dp.to[dp.count] = to;
+  dp.count++;
+}
+
+template <typename T>
+bool
+readValues(std::ifstream& in, T* dst, size_t count)
+{
+  in.read(reinterpret_cast<char*>(dst), std::streamsize(sizeof(T) * count));
+  return bool(in);
+}
+
+} // namespace
+
+
+bool
+load(const std::string& path, std::string& error)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+  {
+    error = "cannot open " + path;
+    return false;
+  }
+
+  char magic[8];
+  uint32_t header[3];
+
+  if (!readValues(in, magic, 8) or std::memcmp(magic, FILE_MAGIC, 8) != 0)
+  {
+    error = path + " is not an Elsa network file";
+    return false;
+  }
+
+  if (!readValues(in, header, 3) or header[0] != FILE_VERSION
+      or header[1] != uint32_t(INPUTS) or header[2] != uint32_t(L1))
+  {
+    error = path + " has an unsupported version or architecture";
+    return false;
+  }
+
+  Network loaded;
+  loaded.featureWeights.resize(size_t(INPUTS) * L1);
+  loaded.featureBias.resize(L1);
+  loaded.outputWeights.resize(2 * L1);
+
+  if (!readValues(in, loaded.featureWeights.data(), loaded.featureWeights.size())
+      or !readValues(in, loaded.featureBias.data(), loaded.featureBias.size())
+      or !readValues(in, loaded.outputWeights.data(), loaded.outputWeights.size())
+      or !readValues(in, &loaded.outputBias, 1))
+  {
+    error = path + " is truncated";
+    return false;
+  }
+
+  if (in.peek() != std::ifstream::traits_type::eof())
+  {
+    error = path + " has trailing data";
+    return false;
+  }
+
+  net = std::move(loaded);
+  netPath = path;
+  netEpoch++;
+  evalGeneration++;
+  netLoaded = true;
+  return true;
+}
+
+void
+unload() noexcept
+{
+  netLoaded = false;
+  netPath.clear();
+  net = Network();
+  netEpoch++;
+  evalGeneration++;
+}
+
+void
+setUseNnue(bool use) noexcept
+{
+  if (use != useNnue)
+    evalGeneration++;
+  useNnue = use;
+}
+
+uint32_t
+generation() noexcept
+{ return evalGeneration; }
+
+const std::string&
+loadedPath() noexcept
+{ return netPath; }
+
+void
+recordMove(const ChessBoard& pos, Move move) noexcept
+{
+  DirtyPiece& dp = threadAccStack().dirty[pos.plyCount()];
+
+  const Square ip = Square(move & 63);
+  const Square fp = Square((move >> 6) & 63);
+  const Piece moved = pos.pieceOnSquare(ip);
+  const Piece captured = pos.pieceOnSquare(fp);
+  const Color us = color_of(moved);
+
+  dp.parentKey = pos.hashValue;
+  dp.move = move;
+  dp.count = 0;
+
+  if (captured != NO_PIECE)
+    addDirty(dp, captured, fp, SQUARE_NB);
+
+  if (type_of(moved) == PAWN)
+  {
+    if (fp == pos.enPassantSquare())
+    {
+      // Same square arithmetic as ChessBoard::makeMoveEnpassant.
+      const Square capSq = Square(fp - 8 * (2 * us - 1));
+      addDirty(dp, make_piece(~us, PAWN), capSq, SQUARE_NB);
+    }
+    else if ((1ULL << fp) & Rank18)
+    {
+      const PieceType newPt = PieceType(((move >> 18) & 3) + 2);
+      addDirty(dp, moved, ip, SQUARE_NB);
+      addDirty(dp, make_piece(us, newPt), SQUARE_NB, fp);
+      return;
+    }
+  }
+
+  addDirty(dp, moved, ip, fp);
+
+  if (type_of(moved) == KING and std::abs(ip - fp) == 2)
+  {
+    const Piece rook = make_piece(us, ROOK);
+    if (fp > ip)
+      addDirty(dp, rook, Square(ip + 3), Square(ip + 1));
+    else
+      addDirty(dp, rook, Square(ip - 4), Square(ip - 1));
+  }
+}
+
+void
+recordNullMove(const ChessBoard& pos) noexcept
+{
+  DirtyPiece& dp = threadAccStack().dirty[pos.plyCount()];
+  dp.parentKey = pos.hashValue;
+  dp.move = NULL_MOVE;
+  dp.count = 0;
+}
+
+Score
+evaluate(const ChessBoard& pos) noexcept
+{
+  update(pos, WHITE);
+  update(pos, BLACK);
+  return output(threadAccStack().acc[pos.plyCount()], pos.color);
+}
+
+Score
+evaluateFromScratch(const ChessBoard& pos) noexcept
+{
+  Accumulator acc;
+  refresh(pos, acc.values[WHITE], WHITE);
+  refresh(pos, acc.values[BLACK], BLACK);
+  return output(acc, pos.color);
+}
+
+} // namespace nnue
@@ -0,0 +1,101 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "types.h"
+#include <string>
+
+class ChessBoard;
+
+/**
+ * Optional efficiently-updatable neural network evaluation.
+ *
+ * Architecture (HalfKP-style, one hidden layer):
+ *
+ *   input   : per perspective, 64 king squares x 640 piece-squares = 40960
+ *             sparse features. A feature is (own king square, non-king piece,
+ *             its square), with the board mirrored vertically for Black so
+ *             each side sees itself as White. Kings are never features — a
+ *             king move changes *every* feature of that perspective and forces
+ *             a refresh instead.
+ *   layer 1 : 40960 -> 256 int16 accumulator per perspective.
+ *   output  : clipped ReLU [0, QA] on both accumulators, side to move first,
+ *             dotted with 512 int16 weights, plus an int32 bias, scaled by
+ *             SCALE / (QA * QB) to centipawns.
+ *
+ * Network file (little-endian):
+ *   char[8]  "ELSANNUE"
+ *   uint32   version (1)
+ *   uint32   input features (40960)
+ *   uint32   layer-1 size (256)
+ *   int16    feature weights [40960][256]
+ *   int16    feature biases  [256]
+ *   int16    output weights  [512]
+ *   int32    output bias
+ *
+ * The accumulators are not kept in the ChessBoard (it is copied freely, and a
+ * stack of them would make every copy ~256 KB). Instead each thread owns a
+ * stack of them indexed by the board's undo-stack depth. makeMove records the
+ * pieces a move changed (recordMove); evaluate() then brings the accumulator
+ * up to date lazily from the nearest ancestor that already has one, so nodes
+ * cut off before evaluating never pay for an update. unmakeMove needs no hook:
+ * popping the undo stack exposes the parent's still-valid accumulator.
+ */
+namespace nnue
+{
+
+constexpr int INPUTS = 64 * 640;
+constexpr int L1 = 256;
+
+// Set by load() and setUseNnue(); read on every node.
+extern bool netLoaded;
+extern bool useNnue;
+
+// Switch between the network and the hand-crafted eval (UCI `UseNNUE`, `hce`).
+void
+setUseNnue(bool use) noexcept;
+
+// Moves whenever what evaluate() computes does: a network is loaded or
+// dropped, or useNnue changes. Caches of evaluation results compare it with
+// the value they were filled under. Starts at 1, so a zeroed tag is stale.
+uint32_t
+generation() noexcept;
+
+// True when evaluate() should use the network instead of the hand-crafted eval.
+inline bool
+enabled() noexcept
+{ return netLoaded and useNnue; }
+
+// Load a network file. On failure the previously loaded network (if any) is
+// kept, and `error` says why.
+bool
+load(const std::string& path, std::string& error);
+
+// Drop the network; evaluation falls back to the hand-crafted eval.
+void
+unload() noexcept;
+
+// Path of the loaded network, empty if none.
+const std::string&
+loadedPath() noexcept;
+
+// Record the pieces `move` changes. Called from ChessBoard::makeMove after the
+// undo entry is pushed and before the board is touched.
+void
+recordMove(const ChessBoard& pos, Move move) noexcept;
+
+// Record a null move (no piece changes) for ChessBoard::makeNullMove.
+void
+recordNullMove(const ChessBoard& pos) noexcept;
+
+// Side-to-move relative network evaluation.
+Score
+evaluate(const ChessBoard& pos) noexcept;
+
+// evaluate() from freshly refreshed accumulators, ignoring the incremental
+// stack. For debugging the incremental updates only.
+Score
+evaluateFromScratch(const ChessBoard& pos) noexcept;
+
+} // namespace nnue
+
+#endif
@@ -3,14 +3,14 @@
 #define NODE_STATE_H
 
 #include "types.h"
+#include "search_utils.h"
 #include <optional>
 
 
 /**
- * Per-node search state shared across playAllMoves / playSubsetMoves /
- * playMove inside the alpha-beta recursion. `alpha` and `hashf` mutate as
- * moves improve the bound / trigger cutoffs; the rest are constant within
- * a node.
+ * Per-node search state shared across playPickedMoves / playMove inside the
+ * alpha-beta recursion. `alpha` and `hashf` mutate as moves improve the bound
+ * / trigger cutoffs; the rest are constant within a node.
  */
 struct NodeState
 {
@@ -32,11 +32,11 @@ struct NodeState
   std::optional<Score> staticEval = std::nullopt;
 
   // Quiet-move futility flag, set in alphaBeta when the node's static eval sits
-  // a depth-scaled margin below alpha. Consumed in the QUIET stage of
-  // playSubsetMoves to skip the residual quiet moves once one move is searched.
+  // a depth-scaled margin below alpha. Consumed in the late stages of
+  // playPickedMoves to skip the residual quiet moves once one move is searched.
   bool quietFutile = false;
 
-  // Set when playSubsetMoves bails out mid-node on shouldStop(). At that point
+  // Set when playPickedMoves bails out mid-node on shouldStop(). At that point
   // `alpha` only reflects the moves that happened to be searched before the
   // clock ran out, so the node must NOT be written to the TT — a partial bound
   // stored at full depth outlives the iteration and poisons later searches.
@@ -44,6 +44,15 @@ struct NodeState
   // the abort costs no extra clock read on the hot path.
   bool aborted = false;
 
+  // History tables this node reads (quiet ordering, LMR) and writes on a
+  // cutoff, resolved by alphaBeta before the first move is searched.
+  HistoryContext history{};
+
+  // Quiets searched without a cutoff, penalised if a later quiet fails high.
+  // Only the first 64 are kept; later ones are too deep in the ordering for
+  // their score to matter.
+  Varray<Move, 64> quietsSearched{};
+
   constexpr int pvNextIndex() const noexcept { return pvIndex + MAX_PLY - ply; }
 };
 
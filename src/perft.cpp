@@ -0,0 +1,219 @@
+
+#include "perft.h"
+#include "movegen.h"
+#include "single_thread.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace perft
+{
+
+/**
+ * (key, depth) -> node count, shared by every perft thread.
+ *
+ * An entry is two words: `data` packs the count (low 56 bits) with the depth
+ * (high 8), and `check` holds key ^ data. Threads store without locks, so a
+ * reader can see `check` from one store and `data` from another; XOR-ing the
+ * key with the data it belongs to makes such a torn pair fail the lookup
+ * instead of returning another position's count. The words are relaxed
+ * atomics only so those races are defined — they compile to plain moves.
+ *
+ * Always-replace: a perft walk visits each subtree once per transposition, so
+ * the entry just written is the one most likely to be asked for next.
+ */
+class PerftTable
+{
+  struct Entry
+  {
+    std::atomic<uint64_t> check{0};
+    std::atomic<uint64_t> data{0};
+  };
+
+  static constexpr uint64_t COUNT_MASK = (uint64_t(1) << 56) - 1;
+
+  std::unique_ptr<Entry[]> entries;
+  size_t tableSize = 0;
+
+  Entry&
+  entryOf(Key key) const noexcept
+  { return entries[size_t((__uint128_t(key) * tableSize) >> 64)]; }
+
+  public:
+
+  // Reallocate to the largest power-of-two entry count within `megabytes`;
+  // 0 frees the table and turns hashing off.
+  void
+  resize(size_t megabytes)
+  {
+    entries.reset();
+    tableSize = 0;
+
+    if (megabytes == 0)
+      return;
+
+    const size_t maxEntries = (megabytes << 20) / sizeof(Entry);
+    tableSize = size_t(1) << (63 - __builtin_clzll(maxEntries));
+    entries = std::make_unique<Entry[]>(tableSize);
+  }
+
+  bool
+  enabled() const noexcept
+  { return tableSize != 0; }
+
+  void
+  clear() noexcept
+  {
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < tableSize; i++)
+    {
+      entries[i].check.store(0, std::memory_order_relaxed);
+      entries[i].data.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  bool
+  probe(Key key, Depth depth, Nodes& nodes) const noexcept
+  {
+    const Entry& entry = entryOf(key);
+    const uint64_t data  = entry.data.load(std::memory_order_relaxed);
+    const uint64_t check = entry.check.load(std::memory_order_relaxed);
+
+    if (data == 0 or (check ^ data) != key or Depth(data >> 56) != depth)
+      return false;
+
+    nodes = data & COUNT_MASK;
+    return true;
+  }
+
+  void
+  store(Key key, Depth depth, Nodes nodes) noexcept
+  {
+    Entry& entry = entryOf(key);
+    const uint64_t data = (nodes & COUNT_MASK) | (uint64_t(depth) << 56);
+
+    entry.data.store(data, std::memory_order_relaxed);
+    entry.check.store(key ^ data, std::memory_order_relaxed);
+  }
+};
+
+static PerftTable table;
+static size_t threadCount = 1;
+static size_t tableMb = 0;
+
+void
+configure(size_t threads, size_t hashMb)
+{
+  threadCount = std::clamp(threads, size_t(1), size_t(MAX_THREADS));
+
+  if (hashMb != tableMb)
+  {
+    table.resize(hashMb);
+    tableMb = hashMb;
+  }
+}
+
+size_t
+threads() noexcept
+{ return threadCount; }
+
+size_t
+hashMb() noexcept
+{ return tableMb; }
+
+// bulkCount with a table lookup in front of every subtree of depth >= 2.
+// Depth-1 subtrees are a single move-count, cheaper than the lookup.
+static Nodes
+hashedCount(ChessBoard& pos, Depth depth)
+{
+  if (depth <= 1 or !table.enabled())
+    return bulkCount(pos, depth);
+
+  Nodes nodes;
+  if (table.probe(pos.hashValue, depth, nodes))
+    return nodes;
+
+  MoveArray movesArray;
+  generateMoves(pos).getMoves(pos, movesArray);
+
+  nodes = 0;
+  for (const Move move : movesArray)
+  {
+    pos.makeMove(move);
+    nodes += hashedCount(pos, depth - 1);
+    pos.unmakeMove();
+  }
+
+  table.store(pos.hashValue, depth, nodes);
+  return nodes;
+}
+
+Nodes
+count(ChessBoard& pos, Depth depth)
+{
+  table.clear();
+
+  // Too shallow to be worth a split; the two-ply split below also needs
+  // depth >= 3 to leave a subtree under each item.
+  if (threadCount == 1 or depth < 3)
+    return hashedCount(pos, depth);
+
+  struct WorkItem { Move move, reply; };
+
+  vector<WorkItem> items;
+  MoveArray rootMoves;
+  generateMoves(pos).getMoves(pos, rootMoves);
+
+  for (const Move move : rootMoves)
+  {
+    pos.makeMove(move);
+
+    MoveArray replies;
+    generateMoves(pos).getMoves(pos, replies);
+    for (const Move reply : replies)
+      items.push_back({move, reply});
+
+    pos.unmakeMove();
+  }
+
+  if (items.empty())
+    return 0;
+
+  std::atomic<size_t> nextItem{0};
+  std::atomic<Nodes> total{0};
+
+  const auto worker = [&] (ChessBoard board)
+  {
+    Nodes nodes = 0;
+
+    for (size_t i = nextItem.fetch_add(1, std::memory_order_relaxed);
+         i < items.size();
+         i = nextItem.fetch_add(1, std::memory_order_relaxed))
+    {
+      board.makeMove(items[i].move);
+      board.makeMove(items[i].reply);
+      nodes += hashedCount(board, depth - 2);
+      board.unmakeMove();
+      board.unmakeMove();
+    }
+
+    total.fetch_add(nodes, std::memory_order_relaxed);
+  };
+
+  const size_t helperCount = std::min(threadCount, items.size()) - 1;
+
+  vector<std::thread> helpers;
+  for (size_t t = 0; t < helperCount; t++)
+    helpers.emplace_back(worker, pos);
+
+  worker(pos);
+
+  for (auto& helper : helpers)
+    helper.join();
+
+  return total.load(std::memory_order_relaxed);
+}
+
+} // namespace perft
@@ -0,0 +1,45 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "types.h"
+#include "bitboard.h"
+
+/**
+ * Multi-threaded, optionally hashed perft.
+ *
+ * bulkCount() stays the plain single-threaded reference counter. count()
+ * splits the tree at the first two plies into (move, reply) work items that a
+ * pool of threads pulls from a shared counter, each thread walking its items
+ * on its own copy of the board. Splitting two plies deep gives a few hundred
+ * to a few thousand items instead of ~30 root moves, so one heavy root move
+ * no longer leaves every other thread idle at the end.
+ *
+ * With a hash table configured, every subtree of depth >= 2 is looked up by
+ * (position key, depth) before it is walked and stored after. Perft trees are
+ * full of transpositions, so deep counts skip most of their work. The table is
+ * shared by all threads without locks; see PerftTable in perft.cpp.
+ */
+namespace perft
+{
+
+// Worker threads (clamped to 1..MAX_THREADS) and hash table size in MB
+// (0 disables hashing) used by count(). The defaults, 1 thread and no hash,
+// make count() walk the same tree as bulkCount().
+void
+configure(size_t threads, size_t hashMb);
+
+size_t
+threads() noexcept;
+
+size_t
+hashMb() noexcept;
+
+// Perft of `pos` to `depth` under the configured threads and hash. Same
+// signature as bulkCount so TestPosition can take either. The hash table is
+// cleared first, so repeated calls (`elsa speed`) always do the full work.
+Nodes
+count(ChessBoard& pos, Depth depth);
+
+} // namespace perft
+
+#endif
@@ -8,10 +8,14 @@ bool
 is_type<MType::PV>(Move m)
 { return info.isPartOfPv(m); }
 
-SearchData info;
+constinit thread_local SearchData info;
 
 std::atomic<bool> searchStop{false};
 
+std::atomic<bool> threadsStop{false};
+
+std::atomic<bool> searchPonder{false};
+
 #ifndef MOVE_REORDERING
 
 
@@ -27,13 +31,35 @@ prioritizeMoves(MoveArray& movesArray, size_t start)
   return start;
 }
 
+// Stable insertion sort of moves[0..n) by scores[], descending, moving the
+// scores in lockstep. The lists sorted here are short (rarely past a dozen),
+// where this beats std::sort's setup cost.
+static void
+sortByScore(Move* moves, Score* scores, size_t n)
+{
+  for (size_t i = 1; i < n; i++)
+  {
+    const Move  move  = moves[i];
+    const Score score = scores[i];
+    size_t j = i;
+
+    while (j > 0 and scores[j - 1] < score)
+    {
+      moves[j]  = moves[j - 1];
+      scores[j] = scores[j - 1];
+      --j;
+    }
+
+    moves[j]  = move;
+    scores[j] = score;
+  }
+}
+
 size_t
 orderMoves(const ChessBoard& pos, MoveArray& movesArray, MType mTypes, Ply ply, size_t start)
 {
-  const auto seeComparator = [&pos] (Move move1, Move move2)
-  { return seeScore(pos, move1) > seeScore(pos, move2); };
-
   size_t prevS = start;
+  array<Score, MAX_MOVES> scores;
 
   if (hasFlag(mTypes, MType::CAPTURES))  start = prioritizeMoves<MType::CAPTURES>(movesArray, start);
   if (hasFlag(mTypes, MType::PROMOTION)) start = prioritizeMoves<MType::PROMOTION>(movesArray, start);
@@ -44,7 +70,12 @@ orderMoves(const ChessBoard& pos, MoveArray& movesArray, MType mTypes, Ply ply,
   // killers, so quiet killer moves don't get scrambled by a SEE comparison
   // that doesn't apply to them.
   if (mTypes != MType::QUIET)
-    std::sort(movesArray.begin() + prevS, movesArray.begin() + start, seeComparator);
+  {
+    for (size_t i = prevS; i < start; i++)
+      scores[i] = seeScore(pos, movesArray[i]);
+
+    sortByScore(&movesArray[prevS], &scores[prevS], start - prevS);
+  }
 
   // Bad-capture demotion. On the dedicated CAPTURES
   // stage the band is now SEE-sorted descending, so SEE<0 captures sit at
@@ -54,7 +85,7 @@ orderMoves(const ChessBoard& pos, MoveArray& movesArray, MType mTypes, Ply ply,
   // e.g. QxP-defended-by-pawn before any quiet move is tried.
   if (mTypes == MType::CAPTURES)
   {
-    while (start > prevS and seeScore(pos, movesArray[start - 1]) < 0)
+    while (start > prevS and scores[start - 1] < 0)
       --start;
   }
 
@@ -69,6 +100,123 @@ orderMoves(const ChessBoard& pos, MoveArray& movesArray, MType mTypes, Ply ply,
   return (hasFlag(mTypes, MType::QUIET)) ? movesArray.size() : start;
 }
 
+Move
+MovePicker::next()
+{
+  for (;;)
+  {
+    while (cur == stageEnd)
+    {
+      if (currentStage == DONE)
+        return NULL_MOVE;
+
+      currentStage = Stage(currentStage + 1);
+      beginStage();
+    }
+
+    size_t best = cur;
+    for (size_t i = cur + 1; i < stageEnd; i++)
+      if (scores[i] > scores[best])
+        best = i;
+
+    // The best capture left loses material, so every capture left does: end
+    // the stage and leave them in the pool for the quiet stage (or for the
+    // promotion stage, if one is a capture-promotion).
+    if (currentStage == CAPTURES and scores[best] < 0)
+    {
+      stageEnd = cur;
+      continue;
+    }
+
+    // Shift rather than swap the best move into place, so the moves it skips
+    // keep their order: ties go out in generation order, as they would from a
+    // stable sort.
+    const Move move  = moves[best];
+    const int  score = scores[best];
+
+    for (size_t i = best; i > cur; i--)
+    {
+      moves[i]  = moves[i - 1];
+      scores[i] = scores[i - 1];
+    }
+
+    moves[cur]  = move;
+    scores[cur] = score;
+    return moves[cur++];
+  }
+}
+
+void
+MovePicker::beginStage()
+{
+  switch (currentStage)
+  {
+    case CAPTURES:
+      myMoves.getMoves<MType::CAPTURES>(pos, moves);
+      stageEnd = moves.size();
+      scoreSee();
+      break;
+
+    case PROMOTIONS:
+      myMoves.getMoves<MType::QUIET, MType::CHECK>(pos, moves);
+      takeFromPool(is_type<MType::PROMOTION>);
+      scoreSee();
+      break;
+
+    case CHECKS:
+      takeFromPool(is_type<MType::CHECK>);
+      scoreSee();
+      break;
+
+    case PV_MOVES:
+      takeFromPool(is_type<MType::PV>);
+      scoreSee();
+      break;
+
+    case KILLERS:
+    {
+      const auto& killers = killerMoves[ply];
+      takeFromPool([&killers] (Move m) { return killers.search(m); });
+
+      for (size_t i = cur; i < stageEnd; i++)
+        scores[i] = 0;
+      break;
+    }
+
+    // Everything left: the quiets, and the captures the first stage held
+    // back for losing material. Those score 0, so they go after the quiets
+    // with a good history and before the ones with a bad one.
+    case QUIETS:
+    {
+      stageEnd = moves.size();
+
+      const Move counterMove = hc.counterMove ? *hc.counterMove : Move(NULL_MOVE);
+      for (size_t i = cur; i < stageEnd; i++)
+      {
+        const Move move = moves[i];
+
+        if (!is_type<MType::QUIET>(move))
+          scores[i] = 0;
+        else if (counterMove != NULL_MOVE and filter(move) == counterMove)
+          scores[i] = std::numeric_limits<int>::max();
+        else
+          scores[i] = quietHistory(hc, move);
+      }
+      break;
+    }
+
+    case DONE:
+      break;
+  }
+}
+
+void
+MovePicker::scoreSee() noexcept
+{
+  for (size_t i = cur; i < stageEnd; i++)
+    scores[i] = seeScore(pos, moves[i], myMoves.attacks);
+}
+
 // Capture ordering for quiescence search. Unlike orderMoves(), every move here
 // is already known to be a capture, so the prioritize/killer/PV staging is dead
 // weight -- all that's left is the SEE sort. Scoring once into a parallel array
@@ -78,32 +226,16 @@ orderMoves(const ChessBoard& pos, MoveArray& movesArray, MType mTypes, Ply ply,
 // plus `floor` moves regardless, so a node whose captures all lose material
 // still searches its best try rather than collapsing to stand-pat.
 size_t
-orderCaptures(const ChessBoard& pos, MoveArray& movesArray, size_t floor)
+orderCaptures(const ChessBoard& pos, MoveArray& movesArray, size_t floor,
+              const AttackInfo& attacks)
 {
   const size_t n = movesArray.size();
   array<Score, MAX_MOVES> scores;
 
   for (size_t i = 0; i < n; i++)
-    scores[i] = seeScore(pos, movesArray[i]);
-
-  // Insertion sort, descending, moving scores[] in lockstep. Capture lists are
-  // short (rarely past a dozen), where this beats std::sort's setup cost.
-  for (size_t i = 1; i < n; i++)
-  {
-    const Move  move  = movesArray[i];
-    const Score score = scores[i];
-    size_t j = i;
-
-    while (j > 0 and scores[j - 1] < score)
-    {
-      movesArray[j] = movesArray[j - 1];
-      scores[j]     = scores[j - 1];
-      --j;
-    }
+    scores[i] = seeScore(pos, movesArray[i], attacks);
 
-    movesArray[j] = move;
-    scores[j]     = score;
-  }
+  sortByScore(movesArray.begin(), scores.data(), n);
 
   size_t winning = 0;
   while (winning < n and scores[winning] >= 0)
@@ -112,41 +244,216 @@ orderCaptures(const ChessBoard& pos, MoveArray& movesArray, size_t floor)
   return std::max(winning, std::min(floor, n));
 }
 
+// Exchange values by PieceType. The king's only has to outweigh everything
+// else put together: taking it ends an exchange the king walked into.
+static constexpr array<Score, ALL> seeValues = { 0, 100, 320, 300, 530, 910, 3200 };
+
+// Value of what `move` takes; an en passant capture has no piece on its
+// destination square.
+static Score
+capturedValue(Move move)
+{
+  const PieceType fpt = PieceType((move >> 15) & 7);
+  return (is_type<MType::CAPTURES>(move) and fpt == NONE) ? seeValues[PAWN] : seeValues[fpt];
+}
+
+// Pieces of both colours attacking `sq` through `occupied`. Pieces already
+// taken off `occupied` can still show up here; callers mask them out.
+static Bitboard
+attackersTo(const ChessBoard& pos, Square sq, Bitboard occupied)
+{
+  const auto both = [&pos] (PieceType pt)
+  { return pos.getPiece(WHITE, pt) | pos.getPiece(BLACK, pt); };
+
+  const Bitboard queens = both(QUEEN);
+
+  return (attackSquares<BLACK, PAWN>(sq) & pos.piece<WHITE, PAWN>())
+       | (attackSquares<WHITE, PAWN>(sq) & pos.piece<BLACK, PAWN>())
+       | (attackSquares<KNIGHT>(sq, occupied) &  both(KNIGHT))
+       | (attackSquares<BISHOP>(sq, occupied) & (both(BISHOP) | queens))
+       | (attackSquares<ROOK  >(sq, occupied) & (both(ROOK  ) | queens))
+       | (attackSquares<KING  >(sq, occupied) &  both(KING));
+}
+
+// Sliders that reach `sq` once a piece of type `pt` has left the line or
+// diagonal it stood on. A pawn always captures along a diagonal, a knight is
+// never in front of a slider, and a king can stand on either.
+static Bitboard
+xrayAttackers(const ChessBoard& pos, Square sq, PieceType pt, Bitboard occupied)
+{
+  const Bitboard queens = pos.getPiece(WHITE, QUEEN) | pos.getPiece(BLACK, QUEEN);
+  Bitboard revealed = 0;
+
+  if (pt == PAWN or pt == BISHOP or pt == QUEEN or pt == KING)
+    revealed |= attackSquares<BISHOP>(sq, occupied)
+              & (pos.getPiece(WHITE, BISHOP) | pos.getPiece(BLACK, BISHOP) | queens);
+
+  if (pt == ROOK or pt == QUEEN or pt == KING)
+    revealed |= attackSquares<ROOK>(sq, occupied)
+              & (pos.getPiece(WHITE, ROOK) | pos.getPiece(BLACK, ROOK) | queens);
+
+  return revealed;
+}
+
+// `side`'s least valuable piece among `attackers`, with its square in `fromBb`;
+// NONE if it has none. Within a type the highest square goes first, the order
+// getSmallestAttacker() picks in.
+static PieceType
+leastValuable(const ChessBoard& pos, Bitboard attackers, Color side, Bitboard& fromBb)
+{
+  const Bitboard mine = attackers & pos.getPiece(side, ALL);
+  if (mine == 0)
+    return NONE;
+
+  for (const PieceType pt : {PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING})
+  {
+    if (const Bitboard bb = mine & pos.getPiece(side, pt))
+    {
+      fromBb = 1ULL << msbIndex(bb);
+      return pt;
+    }
+  }
+
+  return NONE;
+}
+
+// Swap-list SEE. The captures on the target square are played out forward,
+// least valuable attacker first, with sliders behind each capturer joining in
+// as it leaves. gain[d] is what the side making capture d is up if the
+// exchange stops right after it; folding the list back from the end lets each
+// side stop where it is best off instead.
 Score
-see(const ChessBoard& pos, Square square, Color side, PieceType capturedPiece, Bitboard removedPieces)
+seeScore(const ChessBoard& pos, Move move)
 {
-  const array<Score, ALL> pieceValues = { 0, 100, 320, 300, 530, 910, 3200 };
+  const Square sq = to_sq(move);
+  Bitboard fromBb = 1ULL << from_sq(move);
+
+  Bitboard occupied  = pos.all() ^ fromBb;
+  Bitboard attackers = attackersTo(pos, sq, occupied) & occupied;
+
+  // One capture per piece on the board, at most.
+  array<Score, 32> gain;
+  gain[0] = capturedValue(move);
+
+  PieceType onSquare = type_of(pos.pieceOnSquare(from_sq(move)));
+  Color side = ~pos.color;
+  int d = 0;
 
-  Score value = 0;
-  Square sq = getSmallestAttacker(pos, square, side, removedPieces);
+  for (;;)
+  {
+    const PieceType pt = leastValuable(pos, attackers, side, fromBb);
+    if (pt == NONE)
+      break;
+
+    ++d;
+    gain[d] = seeValues[onSquare] - gain[d - 1];
+
+    occupied ^= fromBb;
+    attackers = (attackers | xrayAttackers(pos, sq, pt, occupied)) & occupied;
+
+    onSquare = pt;
+    side = ~side;
+  }
+
+  for (; d > 0; d--)
+    gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+
+  return gain[0];
+}
+
+// seeScore(pos, move) >= threshold, without playing out the whole exchange.
+// `swap` is how far the side that just captured stands above (or, as the
+// side to answer, below) the threshold if the exchange stops there; as soon
+// as the side to capture cannot change the outcome by going on, it is settled.
+bool
+seeGe(const ChessBoard& pos, Move move, Score threshold)
+{
+  Score swap = capturedValue(move) - threshold;
+  if (swap < 0)
+    return false;
+
+  // Even losing the capturer for nothing clears the threshold.
+  swap = seeValues[type_of(pos.pieceOnSquare(from_sq(move)))] - swap;
+  if (swap <= 0)
+    return true;
+
+  const Square sq = to_sq(move);
+  Bitboard fromBb = 1ULL << from_sq(move);
+
+  Bitboard occupied  = pos.all() ^ fromBb;
+  Bitboard attackers = attackersTo(pos, sq, occupied) & occupied;
+
+  Color side = pos.color;
+  int res = 1;
+
+  for (;;)
+  {
+    side = ~side;
+
+    const PieceType pt = leastValuable(pos, attackers, side, fromBb);
+    if (pt == NONE)
+      break;
+
+    res ^= 1;
+    if ((swap = seeValues[pt] - swap) < res)
+      break;
+
+    occupied ^= fromBb;
+    attackers = (attackers | xrayAttackers(pos, sq, pt, occupied)) & occupied;
+  }
+
+  return res;
+}
+
+// The recursive SEE seeScore() replaced: one getSmallestAttacker() scan of
+// the whole board per capture. Kept as the reference `elsa see` checks and
+// times the swap list against.
+static Score
+seeRecursive(const ChessBoard& pos, Square square, Color side, PieceType capturedPiece, Bitboard removedPieces)
+{
+  const Square sq = getSmallestAttacker(pos, square, side, removedPieces);
 
   if (sq == SQUARE_NB)
-    return value;
+    return 0;
 
-  PieceType attacker = type_of(pos.pieceOnSquare(sq));
-  const auto seeScore = see(pos, square, ~side, attacker, removedPieces | (1ULL << sq));
+  const PieceType attacker = type_of(pos.pieceOnSquare(sq));
+  const Score score = seeRecursive(pos, square, ~side, attacker, removedPieces | (1ULL << sq));
 
-  value = std::max(0, pieceValues[capturedPiece] - seeScore);
-  return value;
+  return std::max(0, seeValues[capturedPiece] - score);
 }
 
 Score
-seeScore(const ChessBoard& pos, Move move)
+seeScoreRecursive(const ChessBoard& pos, Move move)
 {
-  const array<Score, ALL> pieceValues = { 0, 100, 320, 300, 530, 910, 3200 };
-  const Square fp =   to_sq(move);
   const Square ip = from_sq(move);
-  const PieceType fpt = PieceType((move >> 15) & 7);
 
+  return capturedValue(move)
+       - seeRecursive(pos, to_sq(move), ~pos.color, type_of(pos.pieceOnSquare(ip)), 1ULL << ip);
+}
+
+Score
+seeScore(const ChessBoard& pos, Move move, const AttackInfo& attacks)
+{
   const Color side = ~pos.color;
-  const Score initialValue =
-    (is_type<MType::CAPTURES>(move) and fpt == NONE) ? pieceValues[PAWN] : pieceValues[fpt];
 
-  Bitboard removedPieces = 1ULL << ip;
-  PieceType pieceOnSquare = type_of(pos.pieceOnSquare(ip));
+  if (!attacks.has(side))
+    return seeScore(pos, move);
+
+  const Square fp =   to_sq(move);
+  const Bitboard ipBb = 1ULL << from_sq(move);
+
+  // A slider behind the moving piece joins in once it has left; only one on
+  // the same line or diagonal through both squares can.
+  const Bitboard queens = pos.getPiece(side, QUEEN);
+  const bool screened =
+       ((plt::lineMasks    [fp] & ipBb) and (plt::lineMasks    [fp] & (pos.getPiece(side, ROOK  ) | queens)))
+    or ((plt::diagonalMasks[fp] & ipBb) and (plt::diagonalMasks[fp] & (pos.getPiece(side, BISHOP) | queens)));
+
+  // Nothing recaptures: the exchange ends with the first capture.
+  if (!screened and (attacks.byType[side][ALL] & (1ULL << fp)) == 0)
+    return capturedValue(move);
 
-  Score seeScore = initialValue - see(pos, fp, side, pieceOnSquare, removedPieces);
-  return seeScore;
+  return seeScore(pos, move);
 }
 
 void
@@ -82,27 +82,115 @@ class TestPosition
 // rebuilt by copy-assignment (`info = SearchData(...)`) on every search.
 extern std::atomic<bool> searchStop;
 
+// Raised by the main search thread once its own iterative deepening is done,
+// so the Lazy-SMP helpers unwind. Kept apart from searchStop, which belongs
+// to the UCI layer and must not be left set behind a CLI search.
+extern std::atomic<bool> threadsStop;
+
+// Raised by `go ponder` and cleared by `ponderhit` (both on the UCI thread).
+// While it is set the search ignores its time limits: the clock is the
+// opponent's. Once cleared the limits apply as measured from the `go`, so
+// everything searched while pondering counts towards this move's budget.
+extern std::atomic<bool> searchPonder;
+
+// Node counter owned by one search thread. Only that thread writes it, but the
+// main thread reads every helper's counter to total a Lazy-SMP search for the
+// UCI `nodes`/`nps` fields. A relaxed load+store (rather than fetch_add) keeps
+// the single-writer increment as cheap as a plain one while making that
+// cross-thread read well-defined. Copyable so SearchData keeps value semantics.
+class NodeCounter
+{
+  std::atomic<Nodes> count{0};
+
+  public:
+
+  constexpr NodeCounter() noexcept = default;
+
+  NodeCounter(const NodeCounter& other) noexcept
+  : count(other.get()) {}
+
+  NodeCounter&
+  operator=(const NodeCounter& other) noexcept
+  {
+    count.store(other.get(), std::memory_order_relaxed);
+    return *this;
+  }
+
+  void
+  increment() noexcept
+  { count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+  Nodes
+  get() const noexcept
+  { return count.load(std::memory_order_relaxed); }
+};
+
+// Limits of one search beyond its depth and hard time limit, as given by the
+// UCI `go` command. The defaults impose none.
+struct SearchLimits
+{
+  // Time after which no new iteration is started (seconds), 0 for none. See
+  // SearchData::softTimeOver.
+  double softTime = 0;
+
+  // Stop once the main thread has searched this many nodes, 0 for no limit.
+  Nodes nodes = 0;
+
+  // Stop once a mate in this many moves (or fewer) is found, 0 for no limit.
+  int mate = 0;
+
+  // Best lines searched and reported per iteration.
+  size_t multiPv = 1;
+
+  // Root moves the search is restricted to; empty for all of them.
+  MoveArray searchMoves;
+};
+
 class SearchData
 {
   // Set the starting point for clock
-  perf_clock startTime;
+  perf_clock startTime{};
 
   // Store which side to play for search_position
-  Color side;
+  Color side = WHITE;
 
-  uint64_t nodes, qNodes;
+  uint64_t nodes = 0, qNodes = 0;
 
   // Cumulative node count over the entire search (all depths, main + q).
   // Unlike `nodes`/`qNodes` this is NEVER cleared by resetNodeCount(), so it
   // feeds the UCI `nodes`/`nps` fields, which GUIs expect to be cumulative.
-  Nodes searchedNodes = 0;
+  NodeCounter searchedNodes;
+
+  // Latest total of the Lazy-SMP helpers' searchedNodes, refreshed by the main
+  // thread before it reports (see setHelperNodes). Always 0 on a helper.
+  Nodes helperNodes = 0;
 
   // Time provided to find move for current position
-  nanoseconds allotedTime;
+  nanoseconds allotedTime{};
 
   // Time spend on searching for move in position (in secs.)
   double timeForSearch = 0;
 
+  // shouldStop() state: calls left until the next clock read, and the latched
+  // result once it has turned true.
+  int clockPollCountdown = CLOCK_POLL_INTERVAL;
+  bool stopped = false;
+
+  // Soft time limit: once an iteration completes past softTime * timeScale,
+  // no new one is started. Zero for fixed-time searches (movetime, the CLI),
+  // which run until allotedTime, the hard limit.
+  nanoseconds softTime{};
+  double timeScale = 1.0;
+
+  // SearchLimits::nodes and SearchLimits::mate, 0 for none.
+  Nodes nodeLimit = 0;
+  int mateLimit = 0;
+
+  // What updateTimeScale() compares the next iteration against.
+  Move lastBestMove = NULL_MOVE;
+  Score lastEval = 0;
+  int bestMoveStability = 0;
+
   public:
 
   // Transposition-table instrumentation, accumulated over the whole search:
@@ -197,17 +285,18 @@ class SearchData
   // The appended moves are for display only — see pvSearchedLen for why they
   // are fenced off from isPartOfPv().
   void
-  extendPvFromTt(ChessBoard pos, Depth rootDepth)
+  extendPvFromTt(Varray<Move, MAX_PLY>& line, ChessBoard pos, Depth rootDepth) const
   {
-    // With the TT disabled there is no table to walk — and TT_SIZE is 0, so
-    // probeMove()'s `hash % TT_SIZE` would divide by zero.
+    // With the TT disabled there is no table to walk — it is never resized,
+    // so TT_SIZE is 0 and probePvMove()'s bucket index (hash * TT_SIZE) >> 64
+    // always comes out 0, reading bucket 0 of a null bucket array.
     if constexpr (!USE_TT)
       return;
 
     // A line that ended inside quiescence ended *naturally*; appending
     // main-search moves would splice them into the "(...)" tail of the
     // readable PV, misrepresenting them as quiescence moves.
-    if (pvLine.size() > 0 and (pvLine.back() & quiescenceMove()))
+    if (line.size() > 0 and (line.back() & quiescenceMove()))
       return;
 
     // Repetition guard. Two positions can each store the other's move as best
@@ -222,9 +311,9 @@ class SearchData
       return false;
     };
 
-    while (pvLine.size() < pvLine.capacity())
+    while (line.size() < line.capacity())
     {
-      // Depth still owed at this point in the line. pvLine.size() is exactly the
+      // Depth still owed at this point in the line. line.size() is exactly the
       // ply we are standing on (the prefix moves have all been made on `pos`), so
       // a node genuinely on this iteration's PV was searched at `rootDepth - ply`
       // -- extensions only ever push that higher, and reductions never apply on
@@ -235,7 +324,7 @@ class SearchData
       // early in extension-saturated lines is the lesser evil: a floor of 1
       // re-admits depth-1 entries, which is exactly what let the fabricated
       // tail through.
-      const Depth remaining = rootDepth - Depth(pvLine.size());
+      const Depth remaining = rootDepth - Depth(line.size());
       if (remaining < 1)
         break;
 
@@ -247,7 +336,7 @@ class SearchData
       if (move == NULL_MOVE or !isLegalMoveForPosition(move, pos))
         break;
 
-      pvLine.add(move);
+      line.add(move);
       pos.makeMove(move);
 
       if (alreadySeen(pos.hashValue))
@@ -258,16 +347,30 @@ class SearchData
 
   public:
 
-  SearchData()
-  : startTime(perf::now()) {}
+  // constexpr so the thread_local `info` is constant-initialised (see below).
+  constexpr SearchData() = default;
 
-  SearchData(ChessBoard& pos, double _allotedTime)
+  SearchData(ChessBoard& pos, double _allotedTime, const SearchLimits& limits = {})
   : startTime(perf::now()), side(pos.color), nodes(0), qNodes(0),
-    allotedTime(std::chrono::duration_cast<nanoseconds>(std::chrono::duration<double>(_allotedTime)))
+    allotedTime(std::chrono::duration_cast<nanoseconds>(std::chrono::duration<double>(_allotedTime))),
+    softTime(std::chrono::duration_cast<nanoseconds>(std::chrono::duration<double>(limits.softTime))),
+    nodeLimit(limits.nodes), mateLimit(limits.mate)
   {
     const MoveList myMoves = generateMoves(pos);
     MoveArray movesArray;
     myMoves.getMoves(pos, movesArray);
+
+    // `searchmoves`: keep only the listed moves, unless none of them is legal
+    // here, in which case the restriction is ignored.
+    MoveArray restricted;
+    for (const Move move : movesArray)
+      for (const Move allowed : limits.searchMoves)
+        if (filter(move) == filter(allowed))
+          restricted.add(move);
+
+    if (restricted.size() > 0)
+      movesArray = restricted;
+
     Move zeroMove = movesArray[0];
     moveEvals.add(make_pair(zeroMove, VALUE_ZERO));
 
@@ -303,11 +406,98 @@ class SearchData
   }
 
   // Abort predicate polled at every search checkpoint: true when the time
-  // budget is spent OR the UCI layer asked to stop. Used in place of
-  // timeOver() at the abort gates so `stop` (and `go infinite`) work.
+  // budget is spent (and the search is not pondering), the node limit is
+  // reached, the UCI layer asked to stop, or (on a helper) the main thread has
+  // finished. Used in place of timeOver() at the abort gates so
+  // `stop` (and `go infinite`) work.
+  //
+  // The stop flags are relaxed atomic loads, cheap enough to test on every
+  // call, so `stop` is seen at the next checkpoint. The clock is not: it is
+  // read once per CLOCK_POLL_INTERVAL calls (well under a millisecond of
+  // search). The answer is latched once true, because the callers rely on it
+  // staying true: a node that saw its child abort re-tests it to unwind.
   bool
-  shouldStop() const noexcept
-  { return timeOver() || searchStop.load(std::memory_order_relaxed); }
+  shouldStop() noexcept
+  {
+    if (stopped)
+      return true;
+
+    if (searchStop.load(std::memory_order_relaxed)
+     or threadsStop.load(std::memory_order_relaxed))
+      return stopped = true;
+
+    // Tested on every call so `go nodes` stops at the same node every run.
+    if (nodeLimit and totalSearchedNodes() >= nodeLimit)
+      return stopped = true;
+
+    if (--clockPollCountdown > 0)
+      return false;
+
+    clockPollCountdown = CLOCK_POLL_INTERVAL;
+    return stopped = !searchPonder.load(std::memory_order_relaxed) and timeOver();
+  }
+
+  // Rescale the soft limit after a completed iteration (`eval` is side-to-move
+  // relative). Three signals, multiplied:
+  //
+  //   stability  the best move has survived N iterations in a row: each one
+  //              makes a change in the next less likely, down to half time.
+  //   swing      the score fell since the last iteration: something was found
+  //              that the previous depth missed, so keep looking (a rise only
+  //              trims a little — the position is resolving in our favour).
+  //   nodes      the share of this iteration's root nodes spent under the best
+  //              move: near 1 every alternative was refuted quickly, lower
+  //              means several moves needed real work to reject.
+  void
+  updateTimeScale(Move bestMove, Score eval) noexcept
+  {
+    if (filter(bestMove) == filter(lastBestMove))
+      bestMoveStability = std::min(bestMoveStability + 1, 6);
+    else
+      bestMoveStability = 0;
+
+    const double stability = 1.3 - 0.13 * bestMoveStability;
+    const double swing = std::clamp(1.0 + double(lastEval - eval) / 200.0, 0.85, 1.6);
+
+    Nodes bestNodes = 0, rootNodes = 0;
+    for (const auto& [move, nc] : moveNodes)
+    {
+      rootNodes += nc.first + nc.second;
+      if (filter(move) == filter(bestMove))
+        bestNodes = nc.first + nc.second;
+    }
+    const double bestShare = rootNodes ? double(bestNodes) / double(rootNodes) : 0.5;
+    const double spread = 1.5 - bestShare;
+
+    // Never past the hard limit, which aborts the iteration anyway.
+    const double maxScale = softTime.count()
+                          ? double(allotedTime.count()) / double(softTime.count()) : 1.0;
+    timeScale = std::clamp(stability * swing * spread, 0.3, maxScale);
+
+    lastBestMove = bestMove;
+    lastEval = eval;
+  }
+
+  // True when `go mate N` is satisfied: `eval` (side-to-move relative) from a
+  // completed iteration is a forced mate for us in N moves or fewer.
+  bool
+  mateLimitReached(Score eval) const noexcept
+  {
+    const int moves = mateInMoves(eval);
+    return mateLimit and moves > 0 and moves <= mateLimit;
+  }
+
+  // True when a new iteration should not be started: it would most likely be
+  // cut off by the hard limit before finishing, wasting the time spent on it.
+  bool
+  softTimeOver() const noexcept
+  {
+    if (softTime.count() == 0 or searchPonder.load(std::memory_order_relaxed))
+      return false;
+
+    const nanoseconds duration = perf::now() - startTime;
+    return double(duration.count()) >= double(softTime.count()) * timeScale;
+  }
 
   double
   timeSpent() const noexcept
@@ -316,33 +506,41 @@ class SearchData
     return double(duration.count()) / 1e9;
   }
 
-  void
-  addResult(ChessBoard pos, Score eval, Move pv[], Depth depth)
+  // The legal prefix of a raw root pv row, extended from the TT. `searchedLen`
+  // receives the length before the TT tail went on.
+  Varray<Move, MAX_PLY>
+  validatedPv(ChessBoard pos, const Move pv[], Depth depth, size_t& searchedLen) const
   {
-    pvLine.clear();
+    Varray<Move, MAX_PLY> line;
 
-    // Bounded by pvLine's capacity, not MAX_PV_ARRAY_SIZE: the root's row in
+    // Bounded by the line's capacity, not MAX_PV_ARRAY_SIZE: the root's row in
     // the triangular pvArray is only the first MAX_PLY entries, so a full-length
     // legal line would otherwise run off it into the ply-1 row (and the extra
     // moves would be silently dropped by Varray::add anyway).
-    for (size_t i = 0; i < pvLine.capacity(); i++)
+    for (size_t i = 0; i < line.capacity(); i++)
     {
       if (!isLegalMoveForPosition(pv[i], pos))
         break;
-      pvLine.add(pv[i]);
+      line.add(pv[i]);
       pos.makeMove(pv[i]);
     }
 
     // Everything up to here was genuinely searched — freeze that bound before
     // the TT tail goes on, so move ordering only ever sees the searched prefix.
-    pvSearchedLen = pvLine.size();
+    searchedLen = line.size();
 
     // `pos` now sits at the end of the raw line — walk the TT onward from here
     // to recover the moves an early-returning node never wrote to pvArray.
     // `depth` is the iteration that produced this line; the walk needs it to
     // know how much search each recovered move still has to be backed by.
-    extendPvFromTt(pos, depth);
+    extendPvFromTt(line, pos, depth);
+    return line;
+  }
 
+  void
+  addResult(ChessBoard pos, Score eval, Move pv[], Depth depth)
+  {
+    pvLine = validatedPv(pos, pv, depth, pvSearchedLen);
     moveEvals.add(make_pair(pv[0], eval * (2 * side - 1)));
   }
 
@@ -355,11 +553,11 @@ class SearchData
 
   void
   addNode() noexcept
-  { nodes++; searchedNodes++; }
+  { nodes++; searchedNodes.increment(); }
 
   void
   addQNode() noexcept
-  { qNodes++; searchedNodes++; }
+  { qNodes++; searchedNodes.increment(); }
 
   void
   resetNodeCount() noexcept
@@ -368,10 +566,20 @@ class SearchData
   pair<Move, Score> lastIterationResult() const noexcept
   { return moveEvals.back(); }
 
-  // Cumulative nodes (main + quiescence) searched so far, across all depths.
+  // Nodes (main + quiescence) this thread alone has searched, across all depths.
+  Nodes
+  ownSearchedNodes() const noexcept
+  { return searchedNodes.get(); }
+
+  void
+  setHelperNodes(Nodes n) noexcept
+  { helperNodes = n; }
+
+  // Cumulative nodes (main + quiescence) searched so far, across all depths and,
+  // on the main thread, every helper as of the last setHelperNodes().
   Nodes
   totalSearchedNodes() const noexcept
-  { return searchedNodes; }
+  { return searchedNodes.get() + helperNodes; }
 
   // Nodes per second over the whole search so far. Guards against a zero
   // elapsed time on very fast first iterations.
@@ -379,7 +587,8 @@ class SearchData
   nps() const noexcept
   {
     const double elapsed = timeSpent();
-    return elapsed > 0.0 ? Nodes(double(searchedNodes) / elapsed) : searchedNodes;
+    const Nodes total = totalSearchedNodes();
+    return elapsed > 0.0 ? Nodes(double(total) / elapsed) : total;
   }
 
   Nodes
@@ -434,22 +643,35 @@ class SearchData
            << " | " << "PV" << "\n";
   }
 
-  // Reorder root moves for the next iteration: keep the PV move first, then
-  // order the rest by descending subtree size (2*nodes + qNodes) so the
-  // hardest-to-resolve moves are searched earliest.
+  // Move `move` to slot `index` of the root move list.
   void
-  sortMovesOnNodes(Move bestMove)
+  promoteRootMove(Move move, size_t index)
   {
-    for (size_t i = 0; i < moveNodes.size(); i++)
+    for (size_t i = index; i < moveNodes.size(); i++)
     {
-      if (filter(bestMove) == filter(moveNodes[i].first))
+      if (filter(move) == filter(moveNodes[i].first))
       {
-        std::swap(moveNodes[i], moveNodes[0]);
+        std::swap(moveNodes[i], moveNodes[index]);
         break;
       }
     }
+  }
+
+  size_t
+  rootMoveCount() const noexcept
+  { return moveNodes.size(); }
 
-    std::sort(moveNodes.begin() + 1, moveNodes.end(), [](const auto &a, const auto &b) {
+  // Reorder root moves for the next iteration: keep the PV move first (and,
+  // with MultiPV, the other `pinned` - 1 lines after it in line order), then
+  // order the rest by descending subtree size (2*nodes + qNodes) so the
+  // hardest-to-resolve moves are searched earliest.
+  void
+  sortMovesOnNodes(Move bestMove, size_t pinned = 1)
+  {
+    promoteRootMove(bestMove, 0);
+
+    pinned = std::min(pinned, moveNodes.size());
+    std::sort(moveNodes.begin() + pinned, moveNodes.end(), [](const auto &a, const auto &b) {
       Nodes n1 = 2 * a.second.first + a.second.second;
       Nodes n2 = 2 * b.second.first + b.second.second;
       return n1 > n2;
@@ -493,6 +715,92 @@ class SearchData
   }
 };
 
+/**
+ * Hands alphaBeta its moves one at a time, best first, in stages:
+ *
+ *   CAPTURES    captures with SEE >= 0, by SEE
+ *   PROMOTIONS  promotions left over, by SEE
+ *   CHECKS      checking moves left over, by SEE
+ *   PV_MOVES    moves of the previous iteration's PV left over, by SEE
+ *   KILLERS     the ply's killer moves
+ *   QUIETS      everything else: counter move first, then quiets by history,
+ *               with the losing captures held back by CAPTURES ranked at 0
+ *
+ * (the hash move is searched before any of this, see playHashMove). Every
+ * move is scored once, when its stage begins, and next() selects the best of
+ * the stage's remaining moves. The quiet moves are not generated until the
+ * capture stage runs dry, so a cutoff on a capture never pays for them, and a
+ * cutoff on the first move of a stage never pays for ordering the rest.
+ */
+class MovePicker
+{
+  public:
+
+  enum Stage : uint8_t
+  {
+    CAPTURES, PROMOTIONS, CHECKS, PV_MOVES, KILLERS, QUIETS, DONE
+  };
+
+  MovePicker(const ChessBoard& position, const MoveList& moveList, Ply nodePly,
+             const HistoryContext& history)
+  : pos(position), myMoves(moveList), ply(nodePly), hc(history),
+    moves(moveStack[nodePly].moves), scores(moveStack[nodePly].scores)
+  {
+    moves.clear();
+    beginStage();
+  }
+
+  // The next move to search, or NULL_MOVE once every stage is exhausted.
+  Move
+  next();
+
+  // Stage of the move last returned by next().
+  Stage
+  stage() const noexcept
+  { return currentStage; }
+
+  private:
+
+  const ChessBoard& pos;
+  const MoveList& myMoves;
+  const Ply ply;
+  const HistoryContext& hc;
+
+  // moves[0, cur) have been returned, moves[cur, stageEnd) are the current
+  // stage's, moves[stageEnd, size) are left for later stages. scores[] moves
+  // in lockstep with moves[]. Both are the ply's move stack slot.
+  MoveArray& moves;
+  array<int, MAX_MOVES>& scores;
+  size_t cur = 0;
+  size_t stageEnd = 0;
+  Stage currentStage = CAPTURES;
+
+  void
+  beginStage();
+
+  void
+  swapMoves(size_t i, size_t j) noexcept
+  {
+    std::swap(moves[i], moves[j]);
+    std::swap(scores[i], scores[j]);
+  }
+
+  // Move the remaining moves satisfying `pred` to the front of the pool and
+  // make them the current stage.
+  template <typename Pred>
+  void
+  takeFromPool(Pred pred) noexcept
+  {
+    stageEnd = cur;
+    for (size_t i = cur; i < moves.size(); i++)
+      if (pred(moves[i]))
+        swapMoves(i, stageEnd++);
+  }
+
+  void
+  scoreSee() noexcept;
+};
+
 size_t
 orderMoves(const ChessBoard& pos, MoveArray& movesArray, MType moveTypes, Ply ply, size_t start = 0);
 
@@ -502,14 +810,38 @@ orderMoves(const ChessBoard& pos, MoveArray& movesArray, MType moveTypes, Ply pl
  * @param pos board position
  * @param movesArray capture-only move list, reordered in place (SEE descending)
  * @param floor moves to keep even when their SEE is negative
+ * @param attacks the node's attack sets, with the opponent's side filled
  * @return count of leading moves worth searching
  */
 size_t
-orderCaptures(const ChessBoard& pos, MoveArray& movesArray, size_t floor);
+orderCaptures(const ChessBoard& pos, MoveArray& movesArray, size_t floor,
+              const AttackInfo& attacks);
 
+/**
+ * @brief Static exchange evaluation of `move`: the material its side comes out
+ * with once every capture on the destination square that pays has been made.
+ *
+ * @param pos board position, before `move`
+ * @param move capture (or any other move) to score
+ * @return material balance of the exchange, in SEE piece values
+ */
 Score
 seeScore(const ChessBoard& pos, Move move);
 
+// seeScore(pos, move) >= threshold, stopping as soon as the answer is known.
+// For yes/no pruning decisions, where the exact score is not needed.
+bool
+seeGe(const ChessBoard& pos, Move move, Score threshold);
+
+// The recursive SEE seeScore() replaced; same result, kept for `elsa see`.
+Score
+seeScoreRecursive(const ChessBoard& pos, Move move);
+
+// seeScore() for a capture at the node `attacks` belongs to. Captures the
+// opponent cannot answer are scored without the attacker scan.
+Score
+seeScore(const ChessBoard& pos, Move move, const AttackInfo& attacks);
+
 /**
  * @brief Prints all encoded-moves in list to human-readable strings
  *
@@ -519,6 +851,10 @@ seeScore(const ChessBoard& pos, Move move);
 void
 printMovelist(MoveArray myMoves, ChessBoard pos);
 
-extern SearchData info;
+// Per-thread search state: every Lazy-SMP thread runs its own iterative
+// deepening with its own root move list, PV and counters. The thread that
+// calls search() is the main thread, so `info` read after search() returns on
+// that thread holds the main thread's result.
+extern constinit thread_local SearchData info;
 
 #endif
@@ -1,9 +1,18 @@
 
 #include "search_utils.h"
 #include "movegen.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
 
-Move pvArray[MAX_PV_ARRAY_SIZE];
-array<Varray<Move, 2>, MAX_PLY> killerMoves;
+constinit thread_local Move pvArray[MAX_PV_ARRAY_SIZE];
+constinit thread_local array<Varray<Move, 2>, MAX_PLY> killerMoves;
+constinit thread_local SearchHistory* searchHistory = nullptr;
+constinit thread_local MoveStackEntry* moveStack = nullptr;
+
+// Own *searchHistory and moveStack[]; freed when the thread exits.
+static constinit thread_local std::unique_ptr<SearchHistory> historyStorage;
+static constinit thread_local std::unique_ptr<MoveStackEntry[]> moveStackStorage;
 
 void
 movcpy(Move* pTarget, const Move* pSource, int n)
@@ -23,6 +32,101 @@ clearKillers()
     slot.clearKillerMoves();
 }
 
+void
+clearHistory()
+{
+  if (!historyStorage)
+  {
+    historyStorage = std::make_unique<SearchHistory>();
+    searchHistory = historyStorage.get();
+  }
+
+  std::memset(static_cast<void*>(searchHistory), 0, sizeof(SearchHistory));
+}
+
+// Nothing to clear: a slot is refilled by every node that takes it.
+void
+prepareMoveStack()
+{
+  if (moveStackStorage)
+    return;
+
+  moveStackStorage.reset(new MoveStackEntry[MOVE_STACK_SIZE]);
+  moveStack = moveStackStorage.get();
+}
+
+HistoryContext
+historyContext(const ChessBoard& pos)
+{
+  HistoryContext hc;
+  const int plies = pos.plyCount();
+
+  for (int back = 0; back < 2 and back < plies; back++)
+  {
+    const Move prev = pos.moveAt(plies - 1 - back);
+    if (prev == NULL_MOVE)
+      break;
+
+    hc.continuation[back] = &searchHistory->continuation[movedPiece(prev)][to_sq(prev)];
+
+    if (back == 0)
+      hc.counterMove = &searchHistory->counterMoves[movedPiece(prev)][to_sq(prev)];
+  }
+
+  return hc;
+}
+
+int
+quietHistory(const HistoryContext& hc, Move move)
+{
+  const size_t piece = movedPiece(move);
+  const Square to = to_sq(move);
+
+  int score = searchHistory->butterfly[(move >> 22) & 1][from_sq(move)][to];
+
+  for (const PieceToHistory* cont : hc.continuation)
+    if (cont) score += (*cont)[piece][to];
+
+  return score;
+}
+
+// Gravity update: the entry moves towards +/-HISTORY_MAX by `bonus`, less the
+// further it already is in that direction, so it saturates instead of
+// overflowing and a long-stale score is overturned by a few new cutoffs.
+static inline void
+applyBonus(int16_t& entry, int bonus)
+{ entry = int16_t(entry + bonus - entry * __abs(bonus) / HISTORY_MAX); }
+
+static void
+updateMove(const HistoryContext& hc, Move move, int bonus)
+{
+  const size_t piece = movedPiece(move);
+  const Square to = to_sq(move);
+
+  applyBonus(searchHistory->butterfly[(move >> 22) & 1][from_sq(move)][to], bonus);
+
+  for (PieceToHistory* cont : hc.continuation)
+    if (cont) applyBonus((*cont)[piece][to], bonus);
+}
+
+void
+updateQuietHistory(const HistoryContext& hc, Move bestMove,
+                   const Move* searched, size_t searchedCount, Depth depth)
+{
+  // depth^2 so deep cutoffs, which cost and prove more, count more; capped
+  // so one deep node cannot swing an entry most of its range.
+  const int bonus = std::min(int(depth) * int(depth) * 16, HISTORY_MAX / 8);
+
+  updateMove(hc, bestMove, bonus);
+
+  for (size_t i = 0; i < searchedCount; i++)
+    if (searched[i] != bestMove)
+      updateMove(hc, searched[i], -bonus);
+
+  if (hc.counterMove)
+    *hc.counterMove = filter(bestMove);
+}
+
 Score
 checkmateScore(Ply ply)
 { return -VALUE_MATE + (20 * ply); }
@@ -37,6 +141,16 @@ bool
 isMateScore(Score score)
 { return __abs(score) >= int(MATE_BOUND); }
 
+int
+mateInMoves(Score score)
+{
+  if (!isMateScore(score))
+    return 0;
+
+  const int plies = (VALUE_MATE - __abs(score)) / 20;
+  return score > 0 ? (plies + 1) / 2 : -(plies / 2);
+}
+
 int
 nullReduction(Depth depth)
 { return 3 + depth / 4; }
@@ -62,7 +176,7 @@ interestingMove(Move move)
 }
 
 int
-rootReduction(Depth depth, size_t moveNo)
+rootReduction(Depth depth, size_t moveNo, int /* history */)
 {
   if (depth < 3) return 0;
   if (depth < 6) {
@@ -75,8 +189,8 @@ rootReduction(Depth depth, size_t moveNo)
   return 3;
 }
 
-int
-reduction (Depth depth, size_t moveNo)
+static int
+baseReduction(Depth depth, size_t moveNo)
 {
   if (depth < 2) return 0;
   if ((depth < 4) and (moveNo > 9)) return 1; 
@@ -91,6 +205,15 @@ reduction (Depth depth, size_t moveNo)
   return 3;
 }
 
+int
+reduction (Depth depth, size_t moveNo, int history)
+{
+  // One ply per HISTORY_LMR_DIVISOR of history, either way. Never below zero,
+  // and never past the child's remaining depth.
+  const int R = baseReduction(depth, moveNo) - history / HISTORY_LMR_DIVISOR;
+  return std::clamp(R, 0, std::max(0, int(depth) - 1));
+}
+
 int
 searchExtension(
   const ChessBoard& pos,
@@ -4,8 +4,79 @@
 #include "movelist.h"
 
 
-extern Move pvArray[MAX_PV_ARRAY_SIZE];
-extern array<Varray<Move, 2>, MAX_PLY> killerMoves;
+// Per-thread search scratch. Each Lazy-SMP thread walks its own tree, so the
+// triangular PV rows and the killer slots are thread_local; only the TT is
+// shared. constinit keeps the hot-path access a plain TLS load with no
+// lazy-initialisation guard.
+extern constinit thread_local Move pvArray[MAX_PV_ARRAY_SIZE];
+extern constinit thread_local array<Varray<Move, 2>, MAX_PLY> killerMoves;
+
+// Per-ply move buffers. The move picker of an alphaBeta node and the capture
+// list of a quiescence node live in the slot of their ply, not in the frame, so
+// a node neither allocates nor clears 2 KB of stack; its children use the next
+// slot. Allocated by prepareMoveStack(), on the heap for the same reason as the
+// history tables below.
+struct MoveStackEntry
+{
+  MoveArray moves;
+  array<int, MAX_MOVES> scores;
+};
+
+extern constinit thread_local MoveStackEntry* moveStack;
+
+// Quiet-move history. Every table is keyed by what a quiet move moved where,
+// and learns from beta cutoffs: the cutoff move is rewarded, the quiets
+// searched before it at that node are penalised.
+//
+//   butterfly    [side][from][to]                    -- move, out of context
+//   counterMoves [piece][to] of the previous move    -- its last refutation
+//   continuation [piece][to] of the move 1 / 2 plies back -> [piece][to]
+//
+// A piece index is the move's colour bit over its piece type (see movedPiece),
+// so 16 slots cover both colours.
+constexpr size_t PIECE_SLOTS = 16;
+
+using PieceToHistory = array<array<int16_t, SQUARE_NB>, PIECE_SLOTS>;
+
+struct SearchHistory
+{
+  array<array<array<int16_t, SQUARE_NB>, SQUARE_NB>, COLOR_NB> butterfly;
+  array<array<Move, SQUARE_NB>, PIECE_SLOTS> counterMoves;
+  array<array<PieceToHistory, SQUARE_NB>, PIECE_SLOTS> continuation;
+};
+
+// The thread's tables. Heap-allocated by clearHistory() -- continuation alone
+// is 2 MB, too much to put in every thread's TLS block (which glibc carves out
+// of the thread's stack) -- and cleared with the killers at the start of
+// every search, so a fixed-depth search is reproducible.
+extern constinit thread_local SearchHistory* searchHistory;
+
+// The part of the history a node reads and writes, resolved once per node
+// from the last two moves on the board. A null pointer stands for a missing
+// move: the root's parent, or a null move.
+struct HistoryContext
+{
+  PieceToHistory* continuation[2] = {nullptr, nullptr};
+  Move* counterMove = nullptr;
+};
+
+constexpr size_t
+movedPiece(Move m)
+{ return (((m >> 22) & 1) << 3) | ((m >> 12) & 7); }
+
+HistoryContext
+historyContext(const ChessBoard& pos);
+
+// Combined butterfly + continuation score of a quiet move; the ordering key
+// of the quiet stage and an input to reduction().
+int
+quietHistory(const HistoryContext& hc, Move move);
+
+// Reward `bestMove`, which failed high at `depth`, and penalise the quiets
+// searched before it. Also makes `bestMove` the counter move.
+void
+updateQuietHistory(const HistoryContext& hc, Move bestMove,
+                   const Move* searched, size_t searchedCount, Depth depth);
 
 
 void
@@ -17,6 +88,12 @@ resetPvLine();
 void
 clearKillers();
 
+void
+clearHistory();
+
+void
+prepareMoveStack();
+
 Score
 checkmateScore(Ply ply);
 
@@ -25,6 +102,11 @@ checkmateScore(Ply ply);
 bool
 isMateScore(Score score);
 
+// Moves to mate for a mate score: positive when the side the score belongs to
+// mates, negative when it is mated, 0 for a normal evaluation.
+int
+mateInMoves(Score score);
+
 // Null-move search depth reduction for the given remaining depth.
 int
 nullReduction(Depth depth);
@@ -37,7 +119,7 @@ is_type(Move m)
     return (m >> 23) & 1;
 
   if constexpr (mt == MType::QUIET)
-    return ((m >> 20) & 7) == 0;
+    return ((m >> 20) & 3) == 0;
 
   if constexpr (mt == MType::CAPTURES)
     return (m >> 20) & 1;
@@ -48,11 +130,14 @@ is_type(Move m)
   return 0;
 }
 
+// LMR depth reductions. `history` is the move's quietHistory() score (0 for a
+// non-quiet move): quiets that have been refuting well are reduced less,
+// quiets that keep failing low more.
 int
-rootReduction(Depth depth, size_t moveNo);
+rootReduction(Depth depth, size_t moveNo, int history);
 
 int
-reduction (Depth depth, size_t moveNo);
+reduction (Depth depth, size_t moveNo, int history);
 
 bool
 interestingMove(Move move);
@@ -3,15 +3,20 @@
 #include "move_utils.h"
 #include "node_state.h"
 #include "uci.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <sstream>
+#include <thread>
 
-uint64_t
+template <Color c>
+static uint64_t
 bulkCount(ChessBoard& pos, Depth depth)
 {
   if (depth <= 0) return 1;
 
-  const MoveList myMoves = generateMoves(pos);
+  const MoveList myMoves = generateMoves<c>(pos);
 
   if (depth == 1)
     return myMoves.countMoves();
@@ -23,15 +28,23 @@ bulkCount(ChessBoard& pos, Depth depth)
 
   for (const Move move : movesArray)
   {
-    pos.makeMove(move);
-    answer += bulkCount(pos, depth - 1);
+    pos.makeMove<c>(move);
+    answer += bulkCount<~c>(pos, depth - 1);
     pos.unmakeMove();
   }
 
   return answer;
 }
 
-template <bool leafnode = 0>
+uint64_t
+bulkCount(ChessBoard& pos, Depth depth)
+{
+  return pos.color == WHITE
+    ? bulkCount<WHITE>(pos, depth)
+    : bulkCount<BLACK>(pos, depth);
+}
+
+template <Color c, bool leafnode = 0>
 static Score
 quiescenceSearch(ChessBoard& pos, Score alpha, Score beta, Ply ply, int pvIndex)
 {
@@ -45,32 +58,85 @@ quiescenceSearch(ChessBoard& pos, Score alpha, Score beta, Ply ply, int pvIndex)
   // rendering phantom captures in the printed PV (e.g. "Kd4 (Kxe7)").
   pvArray[pvIndex] = NULL_MOVE;
 
-  const MoveList myMoves = generateMoves(pos);
+  // The quiescence root (the node alphaBeta hands over at depth 0) probes and
+  // stores depth-0 entries, so any entry answers it: one stored by another
+  // quiescence root, or a deeper one from the main search. Depth-0 entries are
+  // never deep enough to cut a main-search node. The stored move, when it is a
+  // capture, is searched first.
+  //
+  // Only the root: it is where main-search lines transpose into each other.
+  // Probing every capture sequence below it as well cut more nodes (q-nodes
+  // -22% on the bench against -16%) but paid a table miss on each, and ran
+  // ~10% slower than no probing at all.
+  constexpr bool useTt = USE_TT and leafnode;
+  Move hashMove = NULL_MOVE;
+
+  if constexpr (useTt)
+  {
+    bool ttHit = false;
+    const Score ttValue = tt.lookupPosition(pos.hashValue, 0, ply, alpha, beta, hashMove, ttHit);
+
+    info.ttProbes++;
+    if (ttHit) info.ttHits++;
+
+    if (ttValue != VALUE_UNKNOWN)
+    {
+      info.ttCutoffs++;
+      return ttValue;
+    }
+  }
+
+  // Captures only, every evasion in check: quiet moves are never searched
+  // here. An empty list out of check still needs the quiet pass to tell
+  // stalemate apart; with the king steps already in, that is rare.
+  MoveList myMoves = generateCaptures<c>(pos);
+
+  if (!myMoves.anyMove() and !myMoves.checkers)
+    stagedGenerateMoves<GEN_MOVES, c>(pos, myMoves);
 
   if (!myMoves.anyMove())
     return myMoves.checkers ? checkmateScore(ply) : VALUE_ZERO;
 
-  if (!myMoves.exists<MType::CAPTURES>(pos) and isTheoreticalDraw(pos))
+  const bool hasCaptures = myMoves.exists<MType::CAPTURES>(pos);
+
+  if (!hasCaptures and isTheoreticalDraw(pos))
     return VALUE_DRAW;
 
   info.addQNode();
 
   // Get a 'Stand Pat' Score
-  Score standPat = evaluate(pos);
+  Score standPat = evaluate(pos, myMoves.attacks);
 
   // Checking for beta-cutoff, usually called at the end of move-generation.
   if (standPat >= beta)
+  {
+    if constexpr (useTt)
+      tt.recordPosition(pos.hashValue, 0, ply, beta, Flag::HASH_BETA, NULL_MOVE);
     return beta;
+  }
 
   // int BIG_DELTA = 925;
   // if (standPat < alpha - BIG_DELTA) return alpha;
 
+  const Score originalAlpha = alpha;
   if (standPat > alpha) alpha = standPat;
 
-  if (!myMoves.exists<MType::CAPTURES>(pos))
+  // Stored as exact when the stand-pat raised alpha: it is this node's score
+  // for as long as no capture beats it.
+  const auto storeResult = [&] (Move bestMove) {
+    if constexpr (useTt)
+      tt.recordPosition(pos.hashValue, 0, ply, alpha,
+                        alpha > originalAlpha ? Flag::HASH_EXACT : Flag::HASH_ALPHA, bestMove);
+  };
+
+  if (!hasCaptures)
+  {
+    storeResult(NULL_MOVE);
     return alpha;
+  }
 
-  MoveArray movesArray;
+  MoveArray& movesArray = moveStack[ply].moves;
+  movesArray.clear();
   myMoves.getMoves<MType::CAPTURES>(pos, movesArray);
 
   // Keep the single best capture at thin nodes, the top 3 otherwise, even if
@@ -81,28 +147,51 @@ quiescenceSearch(ChessBoard& pos, Score alpha, Score beta, Ply ply, int pvIndex)
   // orderCaptures() sorts SEE-descending and hands back the prune boundary, so
   // the loop below never needs a per-move SEE check of its own. Without move
   // ordering the list is unsorted and no such boundary exists -- search it all.
-  const size_t moveCount = USE_MOVE_ORDER
-    ? orderCaptures(pos, movesArray, floor) : movesArray.size();
+  size_t moveCount = USE_MOVE_ORDER
+    ? orderCaptures(pos, movesArray, floor, myMoves.attacks) : movesArray.size();
+
+  // The hash capture goes first, even from below the SEE prune boundary: a
+  // search of this position already found it best.
+  if (hashMove != NULL_MOVE)
+  {
+    for (size_t i = 0; i < movesArray.size(); i++)
+    {
+      if (filter(movesArray[i]) != filter(hashMove))
+        continue;
+
+      std::rotate(movesArray.begin(), movesArray.begin() + i, movesArray.begin() + i + 1);
+      if (i >= moveCount)
+        moveCount++;
+      break;
+    }
+  }
 
   int pvNextIndex = pvIndex + MAX_PLY - ply;
+  Move bestMove = NULL_MOVE;
 
   for (size_t moveNo = 0; moveNo < moveCount; ++moveNo)
   {
     Move captureMove = movesArray[moveNo];
 
-    pos.makeMove(captureMove);
-    Score score = -quiescenceSearch(pos, -beta, -alpha, ply + 1, pvNextIndex);
+    pos.makeMove<c>(captureMove);
+    Score score = -quiescenceSearch<~c>(pos, -beta, -alpha, ply + 1, pvNextIndex);
     pos.unmakeMove();
 
     if (info.shouldStop())
       return TIMEOUT;
 
     // Check for Beta-cutoff
-    if (score >= beta) return beta;
+    if (score >= beta)
+    {
+      if constexpr (useTt)
+        tt.recordPosition(pos.hashValue, 0, ply, beta, Flag::HASH_BETA, filter(captureMove));
+      return beta;
+    }
 
     if (score > alpha)
     {
       alpha = score;
+      bestMove = filter(captureMove);
 
       if (ply < MAX_PLY)
       {
@@ -113,6 +202,7 @@ quiescenceSearch(ChessBoard& pos, Score alpha, Score beta, Ply ply, int pvIndex)
     }
   }
 
+  storeResult(bestMove);
   return alpha;
 }
 
@@ -120,23 +210,37 @@ quiescenceSearch(ChessBoard& pos, Score alpha, Score beta, Ply ply, int pvIndex)
 // non-PVS path. ChildPv is a template parameter rather than a bool argument
 // so the child's PV-ness stays compile-time all the way down; the caller
 // resolves the runtime `moveNo == 0` test into one of the two instantiations.
-template <bool ChildPv>
+// `c` is the side to move at the child, the move already made.
+template <Color c, bool ChildPv>
 static Score
 searchChild(
   ChessBoard& pos, Depth depth, Score alpha, Score beta,
   Ply ply, int pvNextIndex, int numExtensions, int R
 )
 {
-  Score eval = -alphaBeta<ChildPv>(pos, depth - 1 - R, -beta, -alpha, ply + 1, pvNextIndex, numExtensions);
+  Score eval = -alphaBeta<c, ChildPv>(pos, depth - 1 - R, -beta, -alpha, ply + 1, pvNextIndex, numExtensions);
 
   // if timed-out, eval will be highly negative thus following code won't execute
   if (R > 0 and eval > alpha)
-    eval = -alphaBeta<ChildPv>(pos, depth - 1, -beta, -alpha, ply + 1, pvNextIndex, numExtensions);
+    eval = -alphaBeta<c, ChildPv>(pos, depth - 1, -beta, -alpha, ply + 1, pvNextIndex, numExtensions);
 
   return eval;
 }
 
-template <ReductionFunc reductionFunction, bool PvNode>
+// LMR reduction for `move`, or 0 when it is not a reduction candidate.
+// lmrOk() only passes quiet non-checking moves, so the history lookup is
+// never spent on a capture.
+template <ReductionFunc reductionFunction>
+static inline int
+lmrReduction(Move move, size_t moveNo, const NodeState& ns)
+{
+  if (!USE_LMR or !lmrOk(move, ns.depth, moveNo))
+    return 0;
+
+  return reductionFunction(ns.depth, moveNo, quietHistory(ns.history, move));
+}
+
+template <Color c, ReductionFunc reductionFunction, bool PvNode>
 static Score
 playMove(ChessBoard& pos, Move move, size_t moveNo, const NodeState& ns)
 {
@@ -148,7 +252,13 @@ playMove(ChessBoard& pos, Move move, size_t moveNo, const NodeState& ns)
   const int   numExtensions = ns.numExtensions;
 
   Score eval = VALUE_ZERO;
-  pos.makeMove(move);
+
+  // Every child probes the table, a depth-1 node's children as quiescence
+  // roots (see quiescenceSearch), so every child is worth the line fill.
+  if constexpr (USE_TT)
+    tt.prefetch(pos.keyAfter(move));
+
+  pos.makeMove<c>(move);
 
   if constexpr (USE_PVS)
   {
@@ -159,16 +269,16 @@ playMove(ChessBoard& pos, Move move, size_t moveNo, const NodeState& ns)
     // only re-searched at full depth + full window if the scout beats alpha.
     if (moveNo == 0)
     {
-      eval = -alphaBeta<PvNode>(pos, depth - 1, -beta, -alpha, ply + 1, pvNextIndex, numExtensions);
+      eval = -alphaBeta<~c, PvNode>(pos, depth - 1, -beta, -alpha, ply + 1, pvNextIndex, numExtensions);
     }
     else
     {
-      const int R = (USE_LMR and lmrOk(move, depth, moveNo)) ? reductionFunction(depth, moveNo) : 0;
+      const int R = lmrReduction<reductionFunction>(move, moveNo, ns);
 
       // A scout is a null-window search: its score is a bound, never the real
       // thing, so it is never a PV node however this node is labelled.
       info.pvsScouts++;
-      eval = -alphaBeta<false>(pos, depth - 1 - R, -alpha - 1, -alpha, ply + 1, pvNextIndex, numExtensions);
+      eval = -alphaBeta<~c, false>(pos, depth - 1 - R, -alpha - 1, -alpha, ply + 1, pvNextIndex, numExtensions);
 
       // Scout beat alpha (and timeout didn't drive it negative): re-search at
       // full depth + full window for the true score. One step undoes both the
@@ -190,13 +300,13 @@ playMove(ChessBoard& pos, Move move, size_t moveNo, const NodeState& ns)
       if (eval > alpha and (eval < beta or R > 0))
       {
         info.pvsResearches++;
-        eval = -alphaBeta<PvNode>(pos, depth - 1, -beta, -alpha, ply + 1, pvNextIndex, numExtensions);
+        eval = -alphaBeta<~c, PvNode>(pos, depth - 1, -beta, -alpha, ply + 1, pvNextIndex, numExtensions);
       }
     }
   }
   else
   {
-    const int R = (USE_LMR and lmrOk(move, depth, moveNo)) ? reductionFunction(depth, moveNo) : 0;
+    const int R = lmrReduction<reductionFunction>(move, moveNo, ns);
 
     // The first move searched at a PV node is the PV candidate, so it inherits
     // PV status; its siblings are assumed worse and searched as ordinary nodes.
@@ -206,12 +316,12 @@ playMove(ChessBoard& pos, Move move, size_t moveNo, const NodeState& ns)
     if constexpr (PvNode)
     {
       eval = moveNo == 0
-        ? searchChild<true >(pos, depth, alpha, beta, ply, pvNextIndex, numExtensions, R)
-        : searchChild<false>(pos, depth, alpha, beta, ply, pvNextIndex, numExtensions, R);
+        ? searchChild<~c, true >(pos, depth, alpha, beta, ply, pvNextIndex, numExtensions, R)
+        : searchChild<~c, false>(pos, depth, alpha, beta, ply, pvNextIndex, numExtensions, R);
     }
     else
     {
-      eval = searchChild<false>(pos, depth, alpha, beta, ply, pvNextIndex, numExtensions, R);
+      eval = searchChild<~c, false>(pos, depth, alpha, beta, ply, pvNextIndex, numExtensions, R);
     }
   }
 
@@ -221,8 +331,8 @@ playMove(ChessBoard& pos, Move move, size_t moveNo, const NodeState& ns)
 
 // Searches the TT-suggested move first at the node's full (boosted) depth so
 // it gets the same effective ply budget as every other move. A beta cutoff
-// here returns without ever running GEN_CHECKS or orderMoves downstream.
-template <bool PvNode>
+// here returns without ever running GEN_CHECKS or the move picker downstream.
+template <Color c, bool PvNode>
 static HashMoveOutcome
 playHashMove(ChessBoard& pos, Move hashMove, NodeState& ns, Move& bestMove)
 {
@@ -238,8 +348,8 @@ playHashMove(ChessBoard& pos, Move hashMove, NodeState& ns, Move& bestMove)
 
   // The hash move is move 0 at this node, so it carries the node's PV status
   // down (same rule as playMove's `moveNo == 0`).
-  pos.makeMove(hashMove);
-  Score eval = -alphaBeta<PvNode>(pos, ns.depth - 1, -ns.beta, -ns.alpha, ns.ply + 1, pvNextIndex, ns.numExtensions);
+  pos.makeMove<c>(hashMove);
+  Score eval = -alphaBeta<~c, PvNode>(pos, ns.depth - 1, -ns.beta, -ns.alpha, ns.ply + 1, pvNextIndex, ns.numExtensions);
   pos.unmakeMove();
 
   if (info.shouldStop())
@@ -251,6 +361,8 @@ playHashMove(ChessBoard& pos, Move hashMove, NodeState& ns, Move& bestMove)
   if (eval >= ns.beta)
   {
     info.hashMoveCutoffs++;
+    if (is_type<MType::QUIET>(hashMove))
+      updateQuietHistory(ns.history, hashMove, nullptr, 0, ns.depth);
     if constexpr (USE_TT)
       tt.recordPosition(pos.hashValue, ns.depth, ns.ply, ns.beta, Flag::HASH_BETA, filter(hashMove));
     out.result = ns.beta;
@@ -269,35 +381,32 @@ playHashMove(ChessBoard& pos, Move hashMove, NodeState& ns, Move& bestMove)
   return out;
 }
 
-template <bool PvNode>
+template <Color c, bool PvNode>
 static Move
-playSubsetMoves(
-  ChessBoard& pos, const MoveList& myMoves, MoveArray& movesArray,
-  size_t start, size_t end,
-  NodeState& ns, Move bestMove, bool futilityStage = false
-)
+playPickedMoves(ChessBoard& pos, const MoveList& myMoves, NodeState& ns, Move bestMove)
 {
-  // myMoves.removedMoves() accounts for moves searched *outside* this array
-  // (the hash-move fast-path searches 1 move before playAllMoves runs).
-  // Without this, LMR's `moveNo < LMR_LIMIT` gate gives the first staged
+  // myMoves.removedMoves() accounts for moves searched *outside* the picker
+  // (the hash-move fast-path searches 1 move before it runs).
+  // Without this, LMR's `moveNo < LMR_LIMIT` gate gives the first picked
   // move an extra full-depth search the old impl wouldn't have done —
   // that's where the ~25% tree-bloat was coming from.
   const size_t moveNoBias = myMoves.removedMoves();
 
-  for (size_t moveNo = start; moveNo < end; ++moveNo)
-  {
-    Move move = movesArray[moveNo];
+  MovePicker picker(pos, myMoves, ns.ply, ns.history);
+  size_t moveNo = 0;
 
+  for (Move move = picker.next(); move != NULL_MOVE; move = picker.next(), ++moveNo)
+  {
     // Quiet-move futility: at a shallow, not-in-check node whose static eval
     // sits a depth-scaled margin below alpha (ns.quietFutile, computed in
     // alphaBeta), the residual quiet moves are very unlikely to raise it. Once
     // at least one move has been searched (bestMove set — so the fail-low
-    // return is backed by a real score), skip the rest. This is reached with
-    // futilityStage == true only for the QUIET residual (captures / promotions
-    // / checks / PV / killers ran in earlier stages), so every move here is
-    // already quiet & non-check — no per-move type test needed. Unverified bet
-    // (cf. razoring's qsearch check); the depth-scaled margin is the safety.
-    if (futilityStage and ns.quietFutile and bestMove != NULL_MOVE)
+    // return is backed by a real score), skip the rest. Only the last stage
+    // prunes (captures / promotions / checks / PV / killers have all run by
+    // then), so every move here is a non-check quiet or a losing capture.
+    // The margin has not been tuned; like razoring's qsearch check, it trades
+    // a small tactical risk for nodes.
+    if (picker.stage() >= MovePicker::QUIETS and ns.quietFutile and bestMove != NULL_MOVE)
       break;
 
     // HASH_ALPHA fallback: remember the first searched move at this node so
@@ -305,7 +414,7 @@ playSubsetMoves(
     if (bestMove == NULL_MOVE)
       bestMove = filter(move);
 
-    Score eval = playMove<reduction, PvNode>(pos, move, moveNo + moveNoBias, ns);
+    Score eval = playMove<c, reduction, PvNode>(pos, move, moveNo + moveNoBias, ns);
 
     // No time left! Flag the node as aborted so the caller skips the TT store.
     if (info.shouldStop())
@@ -323,10 +432,17 @@ playSubsetMoves(
       bestMove = filter(move);
 
       if (is_type<MType::QUIET>(move))
+      {
         killerMoves[ns.ply].addKillerMove(move);
+        updateQuietHistory(ns.history, move, ns.quietsSearched.begin(),
+                           ns.quietsSearched.size(), ns.depth);
+      }
       break;
     }
 
+    if (is_type<MType::QUIET>(move))
+      ns.quietsSearched.add(move);
+
     // Better move found, update the result
     if (eval > ns.alpha) {
       ns.hashf = Flag::HASH_EXACT;
@@ -341,52 +457,19 @@ playSubsetMoves(
   return bestMove;
 }
 
-// PvNode leads the parameter list because `rest` is a pack and must come last.
-template <bool PvNode, int moveGen, MType orderType, MType... rest>
-static Move
-playAllMoves(
-  ChessBoard& pos, MoveList& myMoves,
-  MoveArray movesArray, size_t start,
-  NodeState& ns, Move bestMove
-)
-{
-  if constexpr (moveGen == 0)
-    myMoves.getMoves<MType::CAPTURES>(pos, movesArray);
-
-  if constexpr (moveGen == 1)
-    myMoves.getMoves<MType::QUIET, MType::CHECK>(pos, movesArray);
-
-  size_t end = orderType == MType::QUIET
-    ? movesArray.size()
-    : orderMoves(pos, movesArray, orderType, ns.ply, start);
-
-  // Only the residual QUIET stage may futility-prune; earlier stages (captures,
-  // promotions, checks, PV, killers) always search their moves.
-  bestMove = playSubsetMoves<PvNode>(pos, myMoves, movesArray, start, end, ns, bestMove,
-                                     orderType == MType::QUIET);
-
-  // Out of time — don't walk the remaining stages just to abort in each of them.
-  if (ns.hashf == Flag::HASH_BETA or ns.aborted)
-    return bestMove;
-
-  if constexpr (sizeof...(rest) > 0)
-    return playAllMoves<PvNode, moveGen + 1, rest...>(pos, myMoves, movesArray, end, ns, bestMove);
-
-  return bestMove;
-}
-
 // Lazily compute and cache the node's static evaluation. Multiple search
 // heuristics (RFP today; razoring / futility / improving later) want the same
-// value — compute it at most once per node and reuse it from NodeState.
+// value — compute it at most once per node and reuse it from NodeState. The
+// evaluation starts from the attack sets GEN_METADATA left in myMoves.
 static inline Score
-nodeStaticEval(ChessBoard& pos, NodeState& ns)
+nodeStaticEval(ChessBoard& pos, NodeState& ns, MoveList& myMoves)
 {
   if (!ns.staticEval.has_value())
-    ns.staticEval = evaluate(pos);
+    ns.staticEval = evaluate(pos, myMoves.attacks);
   return *ns.staticEval;
 }
 
-template <bool PvNode>
+template <Color c, bool PvNode>
 Score
 alphaBeta(ChessBoard& pos, Depth depth, Score alpha, Score beta, Ply ply, int pvIndex, int numExtensions, bool doNull)
 {
@@ -395,7 +478,7 @@ alphaBeta(ChessBoard& pos, Depth depth, Score alpha, Score beta, Ply ply, int pv
 
     // Depth 0, starting Quiensense Search
   if (depth <= 0)
-    return quiescenceSearch<1>(pos, alpha, beta, ply, pvIndex);
+    return quiescenceSearch<c, 1>(pos, alpha, beta, ply, pvIndex);
 
   // Terminate this node's PV row before any early return (same reason as in
   // quiescenceSearch). A TT cutoff / draw / RFP / razoring exit that leaves the
@@ -443,10 +526,10 @@ alphaBeta(ChessBoard& pos, Depth depth, Score alpha, Score beta, Ply ply, int pv
   // Movegen: GEN_METADATA + GEN_MOVES first so the extension policy
   // (countMoves), terminal/draw checks, and theoretical-draw recognizer all
   // see complete data. GEN_CHECKS is deferred — it's only needed for
-  // MType::CHECK ordering inside playAllMoves, so a hash-move beta cutoff
-  // skips it (and all of orderMoves/staging) entirely.
+  // the picker's CHECKS stage, so a hash-move beta cutoff skips it (and all
+  // of the move picking) entirely.
   MoveList myMoves;
-  stagedGenerateMoves<GEN_METADATA>(pos, myMoves);
+  stagedGenerateMoves<GEN_METADATA, c>(pos, myMoves);
 
   // Per-node search state. Built here, before RFP, so the node's static eval
   // can be cached in it once (via nodeStaticEval) and reused by every
@@ -468,7 +551,7 @@ alphaBeta(ChessBoard& pos, Depth depth, Score alpha, Score beta, Ply ply, int pv
       and depth <= RFP_MAX_DEPTH
       and !isMateScore(beta))
     {
-      const Score staticEval = nodeStaticEval(pos, ns);
+      const Score staticEval = nodeStaticEval(pos, ns, myMoves);
       if (staticEval - RFP_MARGIN * depth >= beta)
         return staticEval;
     }
@@ -489,10 +572,10 @@ alphaBeta(ChessBoard& pos, Depth depth, Score alpha, Score beta, Ply ply, int pv
       and depth <= RAZOR_MAX_DEPTH
       and !isMateScore(alpha))
     {
-      const Score staticEval = nodeStaticEval(pos, ns);
+      const Score staticEval = nodeStaticEval(pos, ns, myMoves);
       if (staticEval + RAZOR_MARGIN * depth <= alpha)
       {
-        const Score razorScore = quiescenceSearch<1>(pos, alpha, beta, ply, pvIndex);
+        const Score razorScore = quiescenceSearch<c, 1>(pos, alpha, beta, ply, pvIndex);
         if (info.shouldStop())
           return TIMEOUT;
         if (razorScore <= alpha)
@@ -501,7 +584,7 @@ alphaBeta(ChessBoard& pos, Depth depth, Score alpha, Score beta, Ply ply, int pv
     }
   }
 
-  stagedGenerateMoves<GEN_MOVES   >(pos, myMoves);
+  stagedGenerateMoves<GEN_MOVES, c>(pos, myMoves);
 
   if (!myMoves.anyMove())
     return myMoves.checkers ? checkmateScore(ply) : VALUE_ZERO;
@@ -519,7 +602,7 @@ alphaBeta(ChessBoard& pos, Depth depth, Score alpha, Score beta, Ply ply, int pv
     if (doNull
         and myMoves.checkers == 0                 // never null out of check
         and depth >= NMP_MIN_DEPTH                 // too shallow to be worth it
-        and pos.hasNonPawnMaterial(pos.color)      // zugzwang guard
+        and pos.hasNonPawnMaterial(c)              // zugzwang guard
         and !isMateScore(beta))                    // don't manufacture false mates
     {
       const int R = nullReduction(depth);
@@ -529,9 +612,9 @@ alphaBeta(ChessBoard& pos, Depth depth, Score alpha, Score beta, Ply ply, int pv
 
       pos.makeNullMove();
       // Null-window probe around beta — never a PV node, whatever this node is.
-      Score nullScore = -alphaBeta<false>(pos, nullDepth, -beta, -beta + 1,
-                                          ply + 1, pvNextIndex, numExtensions,
-                                          /*doNull=*/false);
+      Score nullScore = -alphaBeta<~c, false>(pos, nullDepth, -beta, -beta + 1,
+                                              ply + 1, pvNextIndex, numExtensions,
+                                              /*doNull=*/false);
       pos.unmakeNullMove();
 
       if (info.shouldStop())
@@ -556,8 +639,8 @@ alphaBeta(ChessBoard& pos, Depth depth, Score alpha, Score beta, Ply ply, int pv
     ns.numExtensions = numExtensions;
   }
 
-  // Quiet-move futility precondition (consumed in the QUIET stage of
-  // playAllMoves -> playSubsetMoves). At a shallow, not-in-check node outside
+  // Quiet-move futility precondition (consumed in the QUIETS stage of
+  // playPickedMoves). At a shallow, not-in-check node outside
   // the mate window whose static eval sits a depth-scaled margin below alpha,
   // the residual quiet moves are very unlikely to raise it. We only *flag* it
   // here; the actual skip happens per-move, after >=1 move is searched, so the
@@ -572,32 +655,30 @@ alphaBeta(ChessBoard& pos, Depth depth, Score alpha, Score beta, Ply ply, int pv
       and depth <= FUTILITY_MAX_DEPTH
       and !isMateScore(alpha))
     {
-      const Score staticEval = nodeStaticEval(pos, ns);
+      const Score staticEval = nodeStaticEval(pos, ns, myMoves);
       ns.quietFutile = (staticEval + FUTILITY_MARGIN * depth <= alpha);
     }
   }
 
   Move bestMove = NULL_MOVE;
+  ns.history = historyContext(pos);
 
-  HashMoveOutcome hashOutcome = playHashMove<PvNode>(pos, hashMove, ns, bestMove);
+  HashMoveOutcome hashOutcome = playHashMove<c, PvNode>(pos, hashMove, ns, bestMove);
   if (hashOutcome.result.has_value())
     return *hashOutcome.result;
 
   // Need check-giving-square data for MType::CHECK ordering downstream.
-  stagedGenerateMoves<GEN_CHECKS>(pos, myMoves);
+  stagedGenerateMoves<GEN_CHECKS, c>(pos, myMoves);
 
-  // Drop the already-searched hash move so subsequent getMoves<>() calls in
-  // playAllMoves don't re-emit it. Both branches now feed the same uniform
-  // playAllMoves<0, …> entry.
+  // Drop the already-searched hash move so the picker's getMoves<>() calls
+  // don't re-emit it.
   if (hashOutcome.searched)
     myMoves.removeMove(hashMove);
 
-  // LMR bias is now derived from myMoves.removedMoves() inside
-  // playSubsetMoves — the hash-move fast-path's removeMove() call already
-  // bumped that counter, so the LMR_LIMIT gate sees the right moveNo.
-  MoveArray movesArray;
-  bestMove = playAllMoves<PvNode, 0, MType::CAPTURES, MType::PROMOTION, MType::CHECK, MType::PV, MType::KILLER, MType::QUIET>
-    (pos, myMoves, movesArray, 0, ns, bestMove);
+  // LMR bias is derived from myMoves.removedMoves() inside playPickedMoves —
+  // the hash-move fast-path's removeMove() call already bumped that counter,
+  // so the LMR_LIMIT gate sees the right moveNo.
+  bestMove = playPickedMoves<c, PvNode>(pos, myMoves, ns, bestMove);
 
   // Skip the store on an aborted node: ns.alpha is a partial bound over however
   // many moves fit in the remaining time, and writing it at full `depth` would
@@ -612,12 +693,17 @@ alphaBeta(ChessBoard& pos, Depth depth, Score alpha, Score beta, Ply ply, int pv
 }
 
 // alphaBeta is declared in the header but only ever called from this TU, so
-// the two instantiations are named here rather than exposing the definition.
-template Score alphaBeta<true >(ChessBoard&, Depth, Score, Score, Ply, int, int, bool);
-template Score alphaBeta<false>(ChessBoard&, Depth, Score, Score, Ply, int, int, bool);
-
-Score
-rootAlphaBeta(ChessBoard& pos, Score alpha, Score beta, Depth depth)
+// the four instantiations are named here rather than exposing the definition.
+template Score alphaBeta<WHITE, true >(ChessBoard&, Depth, Score, Score, Ply, int, int, bool);
+template Score alphaBeta<WHITE, false>(ChessBoard&, Depth, Score, Score, Ply, int, int, bool);
+template Score alphaBeta<BLACK, true >(ChessBoard&, Depth, Score, Score, Ply, int, int, bool);
+template Score alphaBeta<BLACK, false>(ChessBoard&, Depth, Score, Score, Ply, int, int, bool);
+
+// The side to move is tested here, once per root search; from here down every
+// node knows it at compile time.
+template <Color c>
+static Score
+rootAlphaBeta(ChessBoard& pos, Score alpha, Score beta, Depth depth, size_t firstMove)
 {
   int ply{0}, pvIndex{0};
 
@@ -627,13 +713,13 @@ rootAlphaBeta(ChessBoard& pos, Score alpha, Score beta, Depth depth)
 
   NodeState ns{alpha, beta, depth, Ply(ply), pvIndex, 0};
 
-  for (size_t moveNo = 0; moveNo < myMoves.size(); ++moveNo)
+  for (size_t moveNo = firstMove; moveNo < myMoves.size(); ++moveNo)
   {
     Move move = myMoves[moveNo];
 
     // The root is a PV node by definition — every PV node below it is reached
     // by taking first moves from here down.
-    Score eval = playMove<rootReduction, true>(pos, move, moveNo, ns);
+    Score eval = playMove<c, rootReduction, true>(pos, move, moveNo, ns);
 
     info.insertMoveToList(moveNo);
 
@@ -651,35 +737,192 @@ rootAlphaBeta(ChessBoard& pos, Score alpha, Score beta, Depth depth)
   return ns.alpha;
 }
 
-void
-search(ChessBoard board, Depth mDepth, double search_time, std::ostream& writer, bool debug, bool emitUciInfo)
+Score
+rootAlphaBeta(ChessBoard& pos, Score alpha, Score beta, Depth depth, size_t firstMove)
 {
-  resetPvLine();
-  clearKillers();
+  return pos.color == WHITE
+    ? rootAlphaBeta<WHITE>(pos, alpha, beta, depth, firstMove)
+    : rootAlphaBeta<BLACK>(pos, alpha, beta, depth, firstMove);
+}
 
-  if (!generateMoves(board).anyMove())
+namespace
+{
+
+// Lazy-SMP depth staggering (the skip-block scheme Stockfish used before it
+// moved to per-thread search stacks). Helper `id` takes row (id - 1) % 20 and
+// skips depth d whenever ((d + phase) / size) is odd, so the first helpers
+// alternate between the even and odd depths and later ones spread over blocks
+// of 2..4 depths. Without it every helper repeats the main thread's iteration
+// and the only gain is TT warming.
+constexpr array<int, 20> SKIP_SIZE  = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+constexpr array<int, 20> SKIP_PHASE = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+bool
+skipDepth(size_t threadId, Depth depth)
+{
+  if (threadId == 0)
+    return false;
+
+  const size_t row = (threadId - 1) % SKIP_SIZE.size();
+  return ((depth + SKIP_PHASE[row]) / SKIP_SIZE[row]) % 2 != 0;
+}
+
+// Each running helper publishes its thread_local `info` here so the main
+// thread can total their node counters. A slot stays valid until threadsStop
+// is raised: helpers do not return (and so do not destroy `info`) before that.
+array<std::atomic<const SearchData*>, MAX_THREADS> helperData{};
+
+Nodes
+helperSearchedNodes()
+{
+  Nodes total = 0;
+  for (const auto& slot : helperData)
   {
-    writer << "Position has no legal moves! Discarding Search." << endl;
-    return;
+    if (const SearchData* data = slot.load(std::memory_order_acquire))
+      total += data->ownSearchedNodes();
+  }
+  return total;
+}
+
+// One MultiPV line of an iteration: its exact score and raw pvArray row.
+struct RootLine
+{
+  Score score;
+  array<Move, MAX_PLY> pv;
+};
+
+using RootLines = Varray<RootLine, MAX_MULTI_PV>;
+
+// A MultiPV iteration: the root is searched once per line, each time over the
+// root moves no earlier line has taken (they are moved to the front of the
+// root list, see promoteRootMove). Each line is searched with an aspiration
+// window around its score from the last iteration and re-searched, widening
+// as the single-PV loop does, until the score lands inside it, so every line
+// reports an exact score rather than a bound. The first line's pv row is left
+// in pvArray, so the caller records it as the iteration's result like a
+// single-PV one.
+Score
+multiPvRoot(ChessBoard& pos, Depth depth, size_t lineCount, RootLines& lines)
+{
+  Varray<Score, MAX_MULTI_PV> lastScores;
+  for (const RootLine& line : lines)
+    lastScores.add(line.score);
+
+  lines.clear();
+  lineCount = std::min({lineCount, info.rootMoveCount(), lines.capacity()});
+
+  for (size_t lineNo = 0; lineNo < lineCount; lineNo++)
+  {
+    Score alpha = -VALUE_INF, beta = VALUE_INF;
+    if (lineNo < lastScores.size())
+    {
+      alpha = lastScores[lineNo] - VALUE_WINDOW;
+      beta  = lastScores[lineNo] + VALUE_WINDOW;
+    }
+
+    Score eval;
+    for (int valWindowCnt = 1;; valWindowCnt++)
+    {
+      eval = rootAlphaBeta(pos, alpha, beta, depth, lineNo);
+
+      if (info.shouldStop())
+        return TIMEOUT;
+
+      if (eval <= alpha and alpha > -VALUE_INF)
+        alpha = std::max(eval - (VALUE_WINDOW << valWindowCnt), -VALUE_INF);
+      else if (eval >= beta and beta < VALUE_INF)
+        beta  = std::min(eval + (VALUE_WINDOW << valWindowCnt), int(VALUE_INF));
+      else
+        break;
+    }
+
+    RootLine line{eval, {}};
+    movcpy(line.pv.data(), pvArray, MAX_PLY);
+    lines.add(line);
+
+    info.promoteRootMove(pvArray[0], lineNo);
   }
 
-  info = SearchData(board, search_time);
+  movcpy(pvArray, lines[0].pv.data(), MAX_PLY);
+  return lines[0].score;
+}
 
+// `multiPv` is the 1-based line number for a MultiPV search, 0 to leave the
+// field out.
+void
+emitUciIteration(Depth depth, Score eval, const Varray<Move, MAX_PLY>& pvLine,
+                 size_t multiPv = 0)
+{
+  // Built into a string and handed to uciSend() rather than streamed
+  // straight to std::cout: this runs on the search worker while the UCI
+  // loop may be answering `isready` on the main thread, and the two share
+  // one unsynchronised streambuf (see uciSend in uci.h).
+  info.setHelperNodes(helperSearchedNodes());
+
+  long long timeMs = static_cast<long long>(info.timeSpent() * 1000.0);
+  std::ostringstream line;
+  line      << "info depth " << int(depth);
+  if (multiPv)
+    line    << " multipv " << multiPv;
+  if (isMateScore(eval))
+    line    << " score mate " << mateInMoves(eval);
+  else
+    line    << " score cp " << int(eval);
+  line      << " nodes " << info.totalSearchedNodes()
+            << " nps " << info.nps()
+            << " time " << timeMs
+            << " pv";
+  // Print the validated PV (built by addResult above), not the raw
+  // pvArray: every move in it is legality-checked, where a raw walk used
+  // to emit illegal moves (fastchess "Illegal PV move" warnings). It also
+  // carries the TT-reconstructed tail, so a line ending at an
+  // early-returning node still shows its full length. Stop at the first
+  // quiescence move, as the prior raw printer did.
+  for (const Move m : pvLine)
+  {
+    if (m & quiescenceMove()) break;
+    line << " " << moveToUci(m);
+  }
+  uciSend(line.str());
+}
+
+// The iterative-deepening loop shared by the main thread (threadId 0) and the
+// Lazy-SMP helpers. Every thread works on its own thread_local info / pvArray
+// / killerMoves and meets the others only through the TT. Only the main
+// thread reports.
+void
+iterativeDeepening(ChessBoard& board, Depth mDepth, size_t threadId,
+                   std::ostream& writer, bool debug, bool emitUciInfo,
+                   size_t multiPv = 1)
+{
   bool withinValWindow = true;
   Score alpha = -VALUE_INF, beta = VALUE_INF;
   int valWindowCnt = 0;
 
-  if (debug)
-    info.showHeader(writer);
+  // MultiPV is the main thread's alone; helpers keep warming the TT with
+  // single-PV iterations. multiPvRoot sets and widens an aspiration window
+  // for each line itself, so the alpha / beta below go unused with it.
+  const bool multiPvSearch = threadId == 0 and multiPv > 1;
+  RootLines lines;
 
   for (Depth depth = 1; depth <= mDepth;)
   {
-    Score eval = rootAlphaBeta(board, alpha, beta, depth);
+    // A skipped depth is left to the other threads; the aspiration window
+    // carried over from the last completed depth still applies.
+    if (skipDepth(threadId, depth))
+    {
+      depth++;
+      continue;
+    }
+
+    Score eval = multiPvSearch
+               ? multiPvRoot(board, depth, multiPv, lines)
+               : rootAlphaBeta(board, alpha, beta, depth);
 
     if (info.shouldStop())
       break;
 
-    if ((eval <= alpha) or (eval >= beta))
+    if (!multiPvSearch and ((eval <= alpha) or (eval >= beta)))
     {
       // We fell outside the window, so try again with a wider Window
       valWindowCnt++;
@@ -699,45 +942,114 @@ search(ChessBoard board, Depth mDepth, double search_time, std::ostream& writer,
       if (debug)
         info.showLastDepthResult(board, writer);
 
-      if (emitUciInfo)
+      if (emitUciInfo and multiPvSearch)
       {
-        // Built into a string and handed to uciSend() rather than streamed
-        // straight to std::cout: this runs on the search worker while the UCI
-        // loop may be answering `isready` on the main thread, and the two share
-        // one unsynchronised streambuf (see uciSend in uci.h).
-        long long timeMs = static_cast<long long>(info.timeSpent() * 1000.0);
-        std::ostringstream line;
-        line      << "info depth " << int(depth)
-                  << " score cp " << int(eval)
-                  << " nodes " << info.totalSearchedNodes()
-                  << " nps " << info.nps()
-                  << " time " << timeMs
-                  << " pv";
-        // Print the validated PV (built by addResult above), not the raw
-        // pvArray: every move in it is legality-checked, where a raw walk used
-        // to emit illegal moves (fastchess "Illegal PV move" warnings). It also
-        // carries the TT-reconstructed tail, so a line ending at an
-        // early-returning node still shows its full length. Stop at the first
-        // quiescence move, as the prior raw printer did.
-        for (const Move m : info.getPvLine())
+        emitUciIteration(depth, eval, info.getPvLine(), 1);
+        for (size_t lineNo = 1; lineNo < lines.size(); lineNo++)
         {
-          if (m & quiescenceMove()) break;
-          line << " " << moveToUci(m);
+          size_t searchedLen;
+          const auto pvLine = info.validatedPv(board, lines[lineNo].pv.data(), depth, searchedLen);
+          emitUciIteration(depth, lines[lineNo].score, pvLine, lineNo + 1);
         }
-        uciSend(line.str());
       }
+      else if (emitUciInfo)
+        emitUciIteration(depth, eval, info.getPvLine());
 
       info.resetNodeCount();
 
       depth++;
+
+      // Helpers are stopped by the main thread, so only it manages the clock.
+      if (threadId == 0)
+      {
+        info.updateTimeScale(pvArray[0], eval);
+        if (info.softTimeOver() or info.mateLimitReached(eval))
+          break;
+      }
     }
 
     // If found a checkmate
     if (withinValWindow and (__abs(eval) >= VALUE_INF - 500)) break;
 
     // Sort Moves according to time it took to explore the move.
-    info.sortMovesOnNodes(pvArray[0]);
+    info.sortMovesOnNodes(pvArray[0], multiPvSearch ? lines.size() : 1);
   }
+}
+
+void
+helperSearch(ChessBoard board, Depth mDepth, double searchTime, size_t threadId,
+             MoveArray searchMoves)
+{
+  resetPvLine();
+  clearKillers();
+  clearHistory();
+  prepareMoveStack();
+
+  // Only the root restriction carries over: the other limits are the main
+  // thread's to enforce, and it stops the helpers when it is done.
+  SearchLimits limits;
+  limits.searchMoves = searchMoves;
+  info = SearchData(board, searchTime, limits);
+  helperData[threadId].store(&info, std::memory_order_release);
+
+  std::ostringstream sink;
+  iterativeDeepening(board, mDepth, threadId, sink, false, false);
+
+  // Stay registered until the main thread is done with our counter: it may be
+  // summing it right now, and returning would destroy this thread's `info`
+  // under it. Only reached early when the depth limit (or a mate) ends this
+  // helper before the main thread.
+  while (!threadsStop.load(std::memory_order_acquire))
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+} // namespace
+
+void
+search(ChessBoard board, Depth mDepth, double search_time, std::ostream& writer,
+       bool debug, bool emitUciInfo, size_t threads, const SearchLimits& limits)
+{
+  resetPvLine();
+  clearKillers();
+  clearHistory();
+  prepareMoveStack();
+
+  if (!generateMoves(board).anyMove())
+  {
+    writer << "Position has no legal moves! Discarding Search." << endl;
+    return;
+  }
+
+  info = SearchData(board, search_time, limits);
+  evalCacheStats() = EvalCacheStats();
+
+  // Ages every entry left over from earlier searches; must happen before the
+  // helpers start writing so all threads store under the same generation.
+  if constexpr (USE_TT)
+    tt.newSearch();
+
+  threads = std::clamp(threads, size_t(1), size_t(MAX_THREADS));
+  threadsStop.store(false, std::memory_order_relaxed);
+
+  vector<std::thread> helpers;
+  for (size_t threadId = 1; threadId < threads; threadId++)
+    helpers.emplace_back(helperSearch, board, mDepth, search_time, threadId, limits.searchMoves);
+
+  if (debug)
+    info.showHeader(writer);
+
+  iterativeDeepening(board, mDepth, 0, writer, debug, emitUciInfo, limits.multiPv);
+
+  // Final helper total, taken while every helper is still registered. Raising
+  // threadsStop releases them; nothing reads helperData after that.
+  info.setHelperNodes(helperSearchedNodes());
+  threadsStop.store(true, std::memory_order_release);
+
+  for (auto& helper : helpers)
+    helper.join();
+
+  for (auto& slot : helperData)
+    slot.store(nullptr, std::memory_order_relaxed);
 
   info.searchCompleted();
   if (debug)
@@ -750,6 +1062,12 @@ search(ChessBoard board, Depth mDepth, double search_time, std::ostream& writer,
            << " hits=" << info.ttHits << " (" << std::fixed << std::setprecision(1) << hitRate << "%)"
            << " cutoffs=" << info.ttCutoffs << " (" << ttCutRate << "% of hits)" << endl;
 
+    const EvalCacheStats& ec = evalCacheStats();
+    double evalHitRate = ec.probes
+      ? 100.0 * double(ec.hits) / double(ec.probes) : 0.0;
+    writer << "Eval cache: probes=" << ec.probes
+           << " hits=" << ec.hits << " (" << std::fixed << std::setprecision(1) << evalHitRate << "%)" << endl;
+
     double cutoffRate = info.hashMoveInList
       ? 100.0 * double(info.hashMoveCutoffs) / double(info.hashMoveInList) : 0.0;
     double availRate = info.ttMoveProvided
@@ -770,6 +1088,7 @@ search(ChessBoard board, Depth mDepth, double search_time, std::ostream& writer,
     }
 
     writer << "Nodes: " << info.totalSearchedNodes()
+           << " | Threads: " << threads
            << " | Time: " << std::fixed << std::setprecision(2) << info.timeSpent() << "s"
            << " | NPS: " << info.nps() << endl;
     writer << "Search Done!" << endl;
@@ -10,7 +10,7 @@
 #include "endgame.h"
 
 
-typedef int (*ReductionFunc)(Depth depth, size_t move_no);
+typedef int (*ReductionFunc)(Depth depth, size_t move_no, int history);
 
 
 uint64_t
@@ -24,6 +24,17 @@ bulkCount(ChessBoard& pos, Depth depth);
  * @param searchTime time to run the search
  * @param ostream ostream to write the search results
  * @param debug debug mode
+ * @param emitUciInfo print a UCI `info` line after every completed depth
+ * @param threads Lazy-SMP thread count; the calling thread is the main thread
+ *   and threads - 1 helpers share the TT with it (clamped to 1..MAX_THREADS)
+ * @param limits the rest of the UCI `go` limits (see SearchLimits):
+ *   - softTime: time after which no new iteration is started, rescaled every
+ *     iteration by best-move stability, score swings and the root node
+ *     spread; searchTime stays the hard limit. 0 searches the full searchTime.
+ *   - nodes / mate: stop at a node count, or once a short enough mate is found
+ *   - multiPv: number of best lines to search and report (clamped to
+ *     1..MAX_MULTI_PV and the legal move count), each with an exact score
+ *   - searchMoves: restrict the root to these moves
  */
 void
 search(
@@ -32,12 +43,17 @@ search(
   double searchTime = DEFAULT_SEARCH_TIME,
   std::ostream& ostream = std::cout,
   bool debug = false,
-  bool emitUciInfo = false
+  bool emitUciInfo = false,
+  size_t threads = 1,
+  const SearchLimits& limits = {}
 );
 
 /**
  * @brief Returns the evaluation of a board at a given depth
  *
+ * @tparam c the side to move in `board`. Alternates with every ply at compile
+ *   time, so movegen and makeMove below it never test the colour; only the
+ *   root (rootAlphaBeta) reads it from the board.
  * @tparam PvNode true when this node lies on the principal variation — the
  *   root, plus the first move searched at every PV node above it. Never a
  *   runtime value: a child is passed either its parent's PvNode or a literal
@@ -52,13 +68,15 @@ search(
  * @param pvIndex
  * @return Score
  */
-template <bool PvNode>
+template <Color c, bool PvNode>
 Score
 alphaBeta(ChessBoard& pos, Depth depth, Score alpha, Score beta, Ply ply, int pvIndex, int numExtensions, bool doNull = true);
 
 
+// Search the root moves from index `firstMove` of the root move list on; the
+// earlier ones belong to MultiPV lines already found this iteration.
 Score
-rootAlphaBeta(ChessBoard& pos, Score alpha, Score beta, Depth depth);
+rootAlphaBeta(ChessBoard& pos, Score alpha, Score beta, Depth depth, size_t firstMove = 0);
 
 
 #endif
@@ -1,6 +1,8 @@
 ﻿
 #include <unordered_map>
 #include <functional>
+#include <thread>
+#include <optional>
 #include "task.h"
 #include "search.h"
 #include "single_thread.h"
@@ -8,6 +10,8 @@
 #include "tuner.h"
 #include "endgame.h"
 #include "endgame_validation.h"
+#include "nnue.h"
+#include "perft.h"
 
 void
 init(const vector<string>& args)
@@ -21,7 +25,7 @@ init(const vector<string>& args)
   tt.getRandomKeys();
 
   if constexpr (USE_TT) {
-    tt.resize(0);
+    tt.resize(DEFAULT_HASH_MB);
   }
   perf_time dur = perf::now() - start;
   const auto it = dur.count();
@@ -38,6 +42,18 @@ init(const vector<string>& args)
           << "\n\n" << std::flush;
     }
   }
+
+  // `evalfile <path>` switches every command to the network evaluation;
+  // `hce` forces the hand-crafted evaluation even when one is loaded.
+  if (utils::hasArg(args, "evalfile"))
+  {
+    string error;
+    if (!nnue::load(utils::argValue(args, "evalfile"), error))
+      cout << "NNUE network not loaded: " << error << endl;
+  }
+
+  if (utils::hasArg(args, "hce"))
+    nnue::setUseNnue(false);
 }
 
 static vector<TestPosition>
@@ -51,10 +67,36 @@ getTestPositions(const std::vector<std::string>& suite, const std::string& testT
   return testPositions;
 }
 
+// `threads <n>` and `hash <MB>` for the perft commands. Hashing stays off
+// unless asked for, so the default run walks the same tree as bulkCount.
+static void
+configurePerft(const vector<string>& args)
+{
+  const size_t threads = utils::getThreads(args, 1);
+  const size_t hashMb = utils::hasArg(args, "hash") ? utils::getHash(args, 16) : 0;
+
+  perft::configure(threads, hashMb);
+}
+
+static string
+perftLabel()
+{
+  string label = std::to_string(perft::threads())
+               + (perft::threads() == 1 ? " thread" : " threads");
+
+  if (perft::hashMb() != 0)
+    label += ", " + std::to_string(perft::hashMb()) + " MB hash";
+
+  return label;
+}
+
 static void
-accuracyTest()
+accuracyTest(const vector<string>& args)
 {
-  // Argument : elsa accuracy
+  // Argument : elsa accuracy [threads <n>] [hash <MB>]
+
+  configurePerft(args);
+  cout << "Perft : " << perftLabel() << "\n" << endl;
 
   const auto runTests = [] (const vector<TestPosition>& positions)
   {
@@ -66,7 +108,7 @@ accuracyTest()
       const auto depth = pos.maxDepth();
 
       const auto start = perf::now();
-      const bool passed = pos.test(bulkCount, depth);
+      const bool passed = pos.test(perft::count, depth);
       const auto ns = std::chrono::duration_cast<perf_ns_time>(
         perf::now() - start
       ).count();
@@ -101,7 +143,7 @@ accuracyTest()
       Depth depth = pos.maxDepth();
       for (Depth dep = 1; dep <= depth; dep++)
       {
-        if (pos.test(bulkCount, dep))
+        if (pos.test(perft::count, dep))
           continue;
 
         if (dep < minDepth)
@@ -136,16 +178,28 @@ helper()
   puts("/****************   Command List   ****************/\n");
 
   puts("** For Elsa's movegenerator self-accuracy test, type:\n");
-  puts("** elsa accuracy\n");
+  puts("** elsa accuracy [threads <n>] [hash <MB>]\n");
   
   puts("** For Elsa's movegenerator self-speed test, type:\n");
-  puts("** elsa speed\n");
+  puts("** elsa speed [threads <n>] [hash <MB>]\n");
+
+  puts("** For a fixed-depth search benchmark (node signature + NPS), type:\n");
+  puts("** elsa bench [depth <depth>] [threads <n>] [hash <MB>] [json]\n");
+
+  puts("** To measure the search speed gained by TT prefetching, type:\n");
+  puts("** elsa prefetch [hash <MB>] [depth <depth>]\n");
+
+  puts("** To check and time the swap-list SEE against the recursive one, type:\n");
+  puts("** elsa see [depth <depth>]\n");
+
+  puts("** To check that quiescence stores never replace a searched TT entry, type:\n");
+  puts("** elsa ttcheck [depth <depth>] [hash <MB>]\n");
 
   puts("** For Bulk-Counting, type:\n");
-  puts("** elsa count [fen <fen>] [depth <depth>]\n");
+  puts("** elsa count [fen <fen>] [depth <depth>] [threads <n>] [hash <MB>]\n");
 
   puts("** For Evaluating a position, type:\n");
-  puts("** elsa go [fen <fen>] [time <search_time>] [depth <depth>] [debug]\n");
+  puts("** elsa go [fen <fen>] [time <search_time>] [depth <depth>] [threads <n>] [debug]\n");
 
   puts("** For debugging movegenerator, type:\n");
   puts("** elsa debug [fen <fen>] [depth <depth>] [output <filename>]\n");
@@ -170,6 +224,9 @@ helper()
   puts("** elsa tune [data <path.epd>] [iters <n>]\n");
   puts("** elsa tune --all [dir <folder>] [iters <n>]   (tune every .epd in folder)\n");
 
+  puts("** Any command takes [evalfile <path>] to evaluate with an NNUE network,\n");
+  puts("** or [hce] to force the hand-crafted evaluation.\n");
+
   puts("** Note: Commands and flags can be in any order\n");
   puts("         (e.g. 'elsa debug depth 3 fen <fen>' or 'elsa fen <fen> go')\n");
 
@@ -177,12 +234,15 @@ helper()
 }
 
 static void
-speedTest()
+speedTest(const vector<string>& args)
 {
-  // Argument : elsa speed
+  // Argument : elsa speed [threads <n>] [hash <MB>]
+
+  configurePerft(args);
 
   const auto positions = getTestPositions(test_data::speed::suite1, "speed");
   cout << "Positions Found : " << positions.size() << '\n';
+  cout << "Slider lookup   : " << plt::slidingIndexName << '\n';
   
   int64_t totalTime = 0;
   Nodes totalNodes = 0;
@@ -192,7 +252,7 @@ speedTest()
   for (auto pos : positions)
   {
     Nodes currentNodes = pos.nodeCount(1) * loop;
-    uint64_t currentTime = pos.time(bulkCount, loop);
+    uint64_t currentTime = pos.time(perft::count, loop);
 
     totalNodes += currentNodes;
     totalTime  += currentTime;
@@ -202,7 +262,440 @@ speedTest()
   }
 
   const uint64_t speed = totalNodes / totalTime;
-  cout << "Single Thread Speed : " << speed << " M nodes/sec." << endl;
+  cout << "Speed (" << perftLabel() << ") : " << speed << " M nodes/sec." << endl;
+}
+
+static void
+prefetchBench(const vector<string>& args)
+{
+  // Argument : elsa prefetch [hash <MB>] [depth <depth>]
+  //
+  // Searches every accuracy-suite position to a fixed depth twice, once with
+  // TT prefetching off and once with it on, from a cleared table each time.
+  // Single-threaded and depth-bound, so both runs search the same tree; any
+  // NPS difference is memory latency. Use a table well beyond the last-level
+  // cache to see it.
+
+  if constexpr (!USE_TT) {
+    puts("Transposition table disabled, nothing to prefetch.");
+    return;
+  }
+
+  const size_t hashMb = utils::getHash(args, 1024);
+  const Depth depth = utils::getDepth(args, 9);
+
+  tt.resize(hashMb);
+
+  const auto positions = getTestPositions(test_data::accuracy::suite1, "accuracy");
+
+  // Times one search of `fen` from a cleared table.
+  const auto timedSearch = [&] (const string& fen, bool prefetch)
+  {
+    tt.setPrefetch(prefetch);
+    tt.clear();
+    ChessBoard pos(fen);
+
+    const auto start = perf::now();
+    search(pos, depth, 3600, std::cout, false);
+    const auto ns = std::chrono::duration_cast<perf_ns_time>(perf::now() - start).count();
+
+    return std::make_pair(info.totalSearchedNodes(), static_cast<uint64_t>(ns));
+  };
+
+  cout << "Hash = " << tt.size() << " Depth = " << depth
+       << " Positions = " << positions.size() << endl;
+
+  // Off and on alternate per position, so drift in machine load over the run
+  // lands on both sides evenly.
+  array<Nodes, 2> nodes{};
+  array<uint64_t, 2> totalNs{};
+
+  for (const auto& testPos : positions)
+  {
+    for (int prefetch = 0; prefetch < 2; prefetch++)
+    {
+      const auto [n, ns] = timedSearch(testPos.getFen(), prefetch == 1);
+      nodes[prefetch] += n;
+      totalNs[prefetch] += ns;
+    }
+  }
+
+  tt.setPrefetch(true);
+
+  array<double, 2> nps{};
+  for (int prefetch = 0; prefetch < 2; prefetch++)
+  {
+    const double seconds = static_cast<double>(totalNs[prefetch]) / 1e9;
+    nps[prefetch] = static_cast<double>(nodes[prefetch]) / seconds;
+
+    cout << "Prefetch " << (prefetch ? "on " : "off") << " : "
+         << nodes[prefetch] << " nodes in " << std::fixed << std::setprecision(2)
+         << seconds << " s, " << std::setprecision(0) << nps[prefetch] << " nodes/sec." << endl;
+  }
+
+  if (nodes[0] != nodes[1])
+    cout << "Warning: node counts differ, the runs searched different trees." << endl;
+
+  cout << "NPS delta : " << std::showpos << std::setprecision(1)
+       << (nps[1] / nps[0] - 1.0) * 100.0 << std::noshowpos << " %" << endl;
+}
+
+// Calls visit(pos, moves) at every node of the tree below `pos` to `depth`
+// plies, with `moves` the node's legal moves.
+template <typename Visit>
+static void
+walkTree(ChessBoard& pos, Depth depth, Visit& visit)
+{
+  MoveArray movesArray;
+  generateMoves(pos).getMoves(pos, movesArray);
+  visit(pos, movesArray);
+
+  if (depth <= 0)
+    return;
+
+  for (const Move move : movesArray)
+  {
+    pos.makeMove(move);
+    walkTree(pos, depth - 1, visit);
+    pos.unmakeMove();
+  }
+}
+
+static void
+seeBench(const vector<string>& args)
+{
+  // Argument : elsa see [depth <depth>]
+  //
+  // Scores every capture in the accuracy- and speed-suite perft trees, to
+  // `depth` plies, with the recursive SEE and the swap list that replaced it.
+  // Checks first that both agree and that seeGe() agrees with the full score
+  // at a spread of thresholds, then times each over the node's captures, the
+  // three alternating node by node so machine load lands on all of them.
+
+  const Depth depth = utils::getDepth(args, 2);
+  const int repeats = 16;
+  const array<Score, 7> thresholds = { -330, -100, -1, 0, 1, 100, 330 };
+
+  auto positions = getTestPositions(test_data::accuracy::suite1, "accuracy");
+  for (auto& testPos : getTestPositions(test_data::speed::suite1, "speed"))
+    positions.push_back(testPos);
+
+  Nodes nodes = 0, captures = 0;
+  size_t scoreMismatches = 0, geMismatches = 0;
+  array<uint64_t, 3> totalNs{};
+
+  // Summed into and printed, so no timed loop is optimised away.
+  int64_t checksum = 0;
+
+  const auto timed = [&] (auto&& body)
+  {
+    const auto start = perf::now();
+    for (int r = 0; r < repeats; r++)
+      body();
+    return static_cast<uint64_t>(
+      std::chrono::duration_cast<perf_ns_time>(perf::now() - start).count());
+  };
+
+  MoveArray captureList;
+  auto visit = [&] (const ChessBoard& pos, const MoveArray& movesArray)
+  {
+    nodes++;
+    captureList.clear();
+    for (const Move move : movesArray)
+      if (is_type<MType::CAPTURES>(move))
+        captureList.add(move);
+
+    if (captureList.size() == 0)
+      return;
+
+    captures += captureList.size();
+
+    for (const Move move : captureList)
+    {
+      const Score score = seeScore(pos, move);
+
+      if (score != seeScoreRecursive(pos, move) and scoreMismatches++ < 5)
+        cout << "SEE mismatch: " << pos.fen() << " " << printMove(move, pos) << endl;
+
+      for (const Score threshold : thresholds)
+        if (seeGe(pos, move, threshold) != (score >= threshold) and geMismatches++ < 5)
+          cout << "seeGe mismatch: " << pos.fen() << " " << printMove(move, pos)
+               << " threshold " << threshold << endl;
+    }
+
+    totalNs[0] += timed([&] { for (const Move m : captureList) checksum += seeScoreRecursive(pos, m); });
+    totalNs[1] += timed([&] { for (const Move m : captureList) checksum += seeScore(pos, m); });
+    totalNs[2] += timed([&] { for (const Move m : captureList) checksum += seeGe(pos, m, 0); });
+  };
+
+  for (const auto& testPos : positions)
+  {
+    ChessBoard pos(testPos.getFen());
+    walkTree(pos, depth, visit);
+  }
+
+  cout << "Depth = " << depth << " Positions = " << positions.size()
+       << " Nodes = " << nodes << " Captures = " << captures << endl;
+
+  const array<const char*, 3> labels = { "Recursive SEE ", "Swap-list SEE ", "seeGe (0)     " };
+  const double calls = static_cast<double>(captures) * repeats;
+
+  for (size_t i = 0; i < labels.size(); i++)
+  {
+    cout << labels[i] << ": " << std::fixed << std::setprecision(1)
+         << static_cast<double>(totalNs[i]) / calls << " ns/capture";
+    if (i > 0)
+      cout << " (" << std::setprecision(2)
+           << static_cast<double>(totalNs[0]) / static_cast<double>(totalNs[i]) << "x)";
+    cout << endl;
+  }
+
+  cout << "Mismatches : " << scoreMismatches << " scores, " << geMismatches << " thresholds"
+       << " (checksum " << checksum << ")" << endl;
+}
+
+static void
+ttCheck(const vector<string>& args)
+{
+  // Argument : elsa ttcheck [depth <depth>] [hash <MB>]
+  //
+  // Replays the transposition-table stores a quiescence root makes over a
+  // searched entry of the same position, at every node of the accuracy-suite
+  // perft trees to `depth` plies. The searched entry must come out with its
+  // depth, bound, score and move intact, in its own search generation and in
+  // a later one. A depth-0 entry on its own must still be stored and found.
+
+  const Depth depth = utils::getDepth(args, 2);
+  const Depth searched = 8;
+  const Score deepScore = 37, qScore = -120;
+
+  const auto positions = getTestPositions(test_data::accuracy::suite1, "accuracy");
+  tt.resize(utils::getHash(args, 16));
+
+  Nodes nodes = 0;
+  size_t qLost = 0, deepLost = 0;
+
+  // What a quiescence root stores: an exact score or an upper bound when no
+  // capture helped, a lower bound when the stand-pat failed high.
+  const auto quiescenceVisit = [&] (uint64_t hashValue, Move captureMove)
+  {
+    tt.recordPosition(hashValue, 0, 0, qScore, Flag::HASH_EXACT, captureMove);
+    tt.recordPosition(hashValue, 0, 0, qScore, Flag::HASH_ALPHA, NULL_MOVE);
+    tt.recordPosition(hashValue, 0, 0, qScore, Flag::HASH_BETA, NULL_MOVE);
+  };
+
+  const auto deepKept = [&] (uint64_t hashValue, Move deepMove)
+  {
+    Move ttMove = NULL_MOVE;
+    bool ttHit = false;
+    const int value = tt.lookupPosition(hashValue, searched, 0, -VALUE_INF, VALUE_INF, ttMove, ttHit);
+
+    return value == deepScore and ttMove == deepMove
+       and tt.probePvMove(hashValue, searched) == deepMove;
+  };
+
+  auto visit = [&] (const ChessBoard& pos, const MoveArray& movesArray)
+  {
+    const uint64_t hashValue = pos.hashValue;
+    Move ttMove = NULL_MOVE;
+    bool ttHit = false;
+
+    // A transposition already checked earlier in the tree holds its searched
+    // entry, which the first store below must not replace.
+    tt.lookupPosition(hashValue, 0, 0, -VALUE_INF, VALUE_INF, ttMove, ttHit);
+    if (ttHit or movesArray.size() == 0)
+      return;
+
+    nodes++;
+    const Move deepMove = movesArray[0];
+    const Move captureMove = movesArray[movesArray.size() - 1];
+
+    tt.recordPosition(hashValue, 0, 0, qScore, Flag::HASH_EXACT, captureMove);
+    if (tt.lookupPosition(hashValue, 0, 0, -VALUE_INF, VALUE_INF, ttMove, ttHit) != qScore
+        and qLost++ < 5)
+      cout << "Quiescence entry not stored: " << pos.fen() << endl;
+
+    tt.recordPosition(hashValue, searched, 0, deepScore, Flag::HASH_EXACT, deepMove);
+    quiescenceVisit(hashValue, captureMove);
+    bool kept = deepKept(hashValue, deepMove);
+
+    tt.newSearch();
+    quiescenceVisit(hashValue, captureMove);
+    kept = kept and deepKept(hashValue, deepMove);
+
+    if (!kept and deepLost++ < 5)
+      cout << "Searched entry replaced: " << pos.fen() << endl;
+  };
+
+  for (const auto& testPos : positions)
+  {
+    tt.clear();
+    ChessBoard pos(testPos.getFen());
+    walkTree(pos, depth, visit);
+  }
+
+  tt.clear();
+
+  cout << "Depth = " << depth << " Positions = " << positions.size()
+       << " Nodes = " << nodes << endl;
+  cout << "Quiescence entries lost : " << qLost << endl;
+  cout << "Searched entries lost   : " << deepLost << endl;
+  puts(qLost == 0 and deepLost == 0 ? "TT check Ok!" : "TT check failed!");
+}
+
+static void
+benchmark(const vector<string>& args)
+{
+  // Argument : elsa bench [depth <depth>] [threads <n>] [hash <MB>] [json]
+  //
+  // Searches every bench-suite position to a fixed depth from a cleared
+  // table and reports the total node count and NPS. Single-threaded, the node
+  // total is a signature of the search: it only moves when a change alters
+  // the tree, whatever the machine or build speed. With helper threads the
+  // tree depends on thread timing, so only the NPS is comparable.
+  //
+  // Each position is then searched once more without a depth limit and
+  // stopped from this thread after STOP_PROBE_DELAY, the way the UCI `stop`
+  // command does it. The time from raising searchStop to search() returning
+  // is the stop latency, reported as worst case and mean. A search that ends
+  // on its own before the stop (mates, small endgame trees) measures nothing
+  // but a thread join, so it is left out of both and only counted.
+
+  const Depth depth = utils::getDepth(args, 10);
+  const size_t threads = utils::getThreads(args, 1);
+  const bool json = utils::hasArg(args, "json");
+
+  if constexpr (USE_TT) {
+    tt.resize(utils::getHash(args, 16));
+  }
+
+  const auto& fens = test_data::bench::suite1;
+
+  // stopNs is empty when the search finished before it could be stopped.
+  struct BenchResult { Nodes nodes; uint64_t ns; std::optional<uint64_t> stopNs; };
+  vector<BenchResult> results;
+
+  static constexpr auto STOP_PROBE_DELAY = std::chrono::milliseconds(20);
+
+  const auto stopLatency = [threads] (const ChessBoard& pos) -> std::optional<uint64_t>
+  {
+    std::ostringstream sink;
+    std::atomic<bool> finished{false};
+    std::thread searcher([&] {
+      search(pos, MAX_DEPTH, 3600, sink, false, false, threads);
+      finished.store(true, std::memory_order_release);
+    });
+
+    std::this_thread::sleep_for(STOP_PROBE_DELAY);
+    const bool interrupted = !finished.load(std::memory_order_acquire);
+    const auto raised = perf::now();
+    searchStop.store(true, std::memory_order_relaxed);
+    searcher.join();
+    const auto ns = static_cast<uint64_t>(std::chrono::duration_cast<perf_ns_time>(
+      perf::now() - raised
+    ).count());
+
+    searchStop.store(false, std::memory_order_relaxed);
+    if (!interrupted)
+      return std::nullopt;
+    return ns;
+  };
+
+  if (!json)
+    cout << "Depth = " << depth << " Threads = " << threads
+         << " Positions = " << fens.size() << '\n' << endl;
+
+  Nodes totalNodes = 0;
+  uint64_t totalNs = 0;
+  uint64_t totalStopNs = 0, maxStopNs = 0;
+  size_t stopped = 0;
+
+  for (size_t i = 0; i < fens.size(); i++)
+  {
+    if constexpr (USE_TT) {
+      tt.clear();
+    }
+
+    ChessBoard pos(fens[i]);
+    std::ostringstream sink;
+
+    const auto start = perf::now();
+    search(pos, depth, 3600, sink, false, false, threads);
+    const auto ns = static_cast<uint64_t>(std::chrono::duration_cast<perf_ns_time>(
+      perf::now() - start
+    ).count());
+
+    const Nodes nodes = info.totalSearchedNodes();
+    const auto stopNs = stopLatency(pos);
+    results.push_back({nodes, ns, stopNs});
+    totalNodes += nodes;
+    totalNs += ns;
+
+    if (stopNs)
+    {
+      stopped++;
+      totalStopNs += *stopNs;
+      maxStopNs = std::max(maxStopNs, *stopNs);
+    }
+
+    if (!json)
+    {
+      cout << "Position " << std::setw(2) << (i + 1) << " : " << std::setw(10) << nodes
+           << " nodes  " << std::fixed << std::setprecision(1)
+           << static_cast<double>(ns) / 1e6 << " ms  stop ";
+      if (stopNs)
+        cout << std::setprecision(3) << static_cast<double>(*stopNs) / 1e6 << " ms" << endl;
+      else
+        cout << "-- (finished first)" << endl;
+    }
+  }
+
+  const uint64_t totalMs = totalNs / 1000000;
+  const uint64_t nps = totalNs ? totalNodes * 1000000000ULL / totalNs : 0;
+  const double maxStopMs = static_cast<double>(maxStopNs) / 1e6;
+  const double meanStopMs = stopped ? static_cast<double>(totalStopNs) / 1e6
+                                    / static_cast<double>(stopped) : 0.0;
+
+  if (json)
+  {
+    cout << "{\n"
+         << "  \"depth\": " << depth << ",\n"
+         << "  \"threads\": " << threads << ",\n"
+         << "  \"hash\": " << utils::getHash(args, 16) << ",\n"
+         << "  \"positions\": [\n";
+
+    cout << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < fens.size(); i++)
+    {
+      cout << "    { \"fen\": \"" << fens[i] << "\", \"nodes\": " << results[i].nodes
+           << ", \"time_ms\": " << results[i].ns / 1000000 << ", \"stop_ms\": ";
+      if (results[i].stopNs)
+        cout << static_cast<double>(*results[i].stopNs) / 1e6;
+      else
+        cout << "null";
+      cout << " }" << (i + 1 < fens.size() ? ",\n" : "\n");
+    }
+
+    cout << "  ],\n"
+         << "  \"nodes\": " << totalNodes << ",\n"
+         << "  \"time_ms\": " << totalMs << ",\n"
+         << "  \"nps\": " << nps << ",\n"
+         << "  \"stop_probed\": " << fens.size() << ",\n"
+         << "  \"stop_interrupted\": " << stopped << ",\n"
+         << "  \"stop_max_ms\": " << maxStopMs << ",\n"
+         << "  \"stop_mean_ms\": " << meanStopMs << "\n"
+         << "}" << endl;
+    return;
+  }
+
+  cout << "\n===========================\n"
+       << "Total time (ms) : " << totalMs << '\n'
+       << "Nodes searched  : " << totalNodes << '\n'
+       << "Nodes/second    : " << nps << '\n'
+       << "Stops measured  : " << stopped << " of " << fens.size()
+       << " (the rest finished first)\n"
+       << "Stop max (ms)   : " << std::setprecision(3) << maxStopMs << '\n'
+       << "Stop mean (ms)  : " << meanStopMs << endl;
 }
 
 static void
@@ -229,14 +722,15 @@ setParamswithDifficulty(string difficulty, double& searchTime, Depth& searchDept
 static void
 directSearch(const vector<string> &args)
 {
-  // elsa [depth <depth>] [fen <fen>] [debug] [time <search_time>] go
+  // elsa [depth <depth>] [fen <fen>] [debug] [time <search_time>] [threads <n>] go
 
   const string fen = utils::getFen(args, START_FEN);
   const double searchTime = utils::getTime(args, DEFAULT_SEARCH_TIME);
   const Depth searchDepth = utils::getDepth(args, MAX_DEPTH);
+  const size_t threads = utils::getThreads(args, 1);
 
   ChessBoard pos(fen);
-  search(pos, searchDepth, searchTime, std::cout, true);
+  search(pos, searchDepth, searchTime, std::cout, true, false, threads);
 }
 
 static void
@@ -263,21 +757,23 @@ bestMoveSearch(const vector<string> &args)
 static void
 nodeCount(const vector<string> &args)
 {
-  // elsa [depth <depth>] [fen <fen>] count
+  // elsa [depth <depth>] [fen <fen>] [threads <n>] [hash <MB>] count
 
   const string fen = utils::getFen(args, START_FEN);
   const Depth depth = utils::getDepth(args, 6);
 
+  configurePerft(args);
   ChessBoard pos(fen);
 
   cout << "Fen = " << fen << '\n';
-  cout << "Depth = " << depth << "\n" << endl;
+  cout << "Depth = " << depth << '\n';
+  cout << "Perft = " << perftLabel() << " (" << plt::slidingIndexName << " sliders)\n" << endl;
 
-  const auto &[nodes, t] = perf::run_algo(bulkCount, pos, depth);
+  const auto &[nodes, t] = perf::run_algo(perft::count, pos, depth);
 
-  cout << "Nodes(single-thread) = " << nodes << '\n';
-  cout << "Time (single-thread) = " << t << " sec.\n";
-  cout << "Speed(single-thread) = " << static_cast<double>(nodes) / (t * 1e6)
+  cout << "Nodes = " << nodes << '\n';
+  cout << "Time  = " << t << " sec.\n";
+  cout << "Speed = " << static_cast<double>(nodes) / (t * 1e6)
         << " M nodes/sec.\n" << endl;
 }
 
@@ -400,8 +896,12 @@ task(const vector<string>& args)
   // Command map that associates commands with their handler functions
   const std::unordered_map<string, std::function<void(const vector<string>&)>> commandMap = {
     {"help",     [](const auto&){ helper(); }},
-    {"accuracy", [](const auto&){ accuracyTest(); }},
-    {"speed",    [](const auto&){ speedTest(); }},
+    {"accuracy", [](const auto& arguments){ accuracyTest(arguments); }},
+    {"speed",    [](const auto& arguments){ speedTest(arguments); }},
+    {"prefetch", [](const auto& arguments){ prefetchBench(arguments); }},
+    {"see",      [](const auto& arguments){ seeBench(arguments); }},
+    {"ttcheck",  [](const auto& arguments){ ttCheck(arguments); }},
+    {"bench",    [](const auto& arguments){ benchmark(arguments); }},
     {"go",       [](const auto& arguments){ directSearch(arguments); }},
     {"count",    [](const auto& arguments){ nodeCount(arguments); }},
     {"movegen",  [](const auto& arguments){ debugMoveGenerator(arguments); }},
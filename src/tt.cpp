@@ -3,6 +3,15 @@
 #include "tt.h"
 #include "search_utils.h"   // isMateScore
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <omp.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
 using std::string;
 using std::to_string;
 
@@ -46,36 +55,77 @@ TranspositionTable::getRandomKeys() noexcept
     hashIndex[i] = rng();
 }
 
+// Alignment of the table allocation. 2 MB is the x86-64 huge-page size, so a
+// table aligned to it can be backed by huge pages from its first byte — one TLB
+// entry then covers 32768 buckets instead of 64. Probes land at random across
+// the whole table, so with 4 KB pages nearly every probe is also a TLB miss.
+static constexpr size_t TT_ALIGNMENT = size_t(2) << 20;
+
 void
 TranspositionTable::freeTables()
 {
-  if (TT_SIZE == 0)
+  if (buckets == nullptr)
     return;
 
-  delete[] ttPrimary;
-  delete[] ttSecondary;
+#if defined(_WIN32)
+  _aligned_free(buckets);
+#else
+  std::free(buckets);
+#endif
+  buckets = nullptr;
+  TT_SIZE = 0;
 }
 
 void
 TranspositionTable::allocateTables()
 {
-  ttPrimary   = new ZobristHashKey[TT_SIZE]();
-  ttSecondary = new ZobristHashKey[TT_SIZE]();
+  // Every size handed in here is a power of two at least 1 MB, hence a
+  // multiple of 64 bytes — but only a multiple of TT_ALIGNMENT from 2 MB up,
+  // which aligned_alloc requires. Round up; the slack is never indexed.
+  const size_t bytes = sizeof(TTBucket) * TT_SIZE;
+  const size_t allocBytes = (bytes + TT_ALIGNMENT - 1) / TT_ALIGNMENT * TT_ALIGNMENT;
+
+#if defined(_WIN32)
+  void* mem = _aligned_malloc(allocBytes, TT_ALIGNMENT);
+#else
+  void* mem = std::aligned_alloc(TT_ALIGNMENT, allocBytes);
+#endif
+
+  if (mem == nullptr)
+  {
+    std::cerr << "Failed to allocate " << (bytes >> 20)
+              << " MB for the transposition table." << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  // Only a hint: with transparent huge pages off, the kernel ignores it.
+  madvise(mem, allocBytes, MADV_HUGEPAGE);
+#endif
+
+  buckets = static_cast<TTBucket*>(mem);
 }
 
 void
-TranspositionTable::resize(int preset)
+TranspositionTable::resize(size_t megabytes)
 {
   getRandomKeys();
   freeTables();
-  TT_SIZE = ttSizes[preset];
+
+  megabytes = std::clamp(megabytes, size_t(1), size_t(MAX_HASH_MB));
+
+  // Largest power-of-two bucket count that fits.
+  const size_t maxBuckets = (megabytes << 20) / sizeof(TTBucket);
+  TT_SIZE = size_t(1) << (63 - __builtin_clzll(maxBuckets));
+
   allocateTables();
+  clear();
 }
 
 string
 TranspositionTable::size() const noexcept
 {
-  uint64_t tableSize = sizeof(ZobristHashKey) * TT_SIZE * 2;
+  uint64_t tableSize = sizeof(TTBucket) * TT_SIZE;
 
   uint64_t KB = 1024, MB = KB * KB, GB = MB * KB;
 
@@ -100,67 +150,109 @@ TranspositionTable::hashKeyUpdate
       + 64 * (piece + (6 * color)) ];
 }
 
-void
-TranspositionTable::recordPosition
-    (uint64_t hashValue, Depth depth, Ply ply, Score eval, Flag flag, Move bestMove) noexcept
+const TTEntry*
+TranspositionTable::findEntry(uint64_t hashValue) const noexcept
 {
-  // Store mate scores as a distance from *this* node, not from the root.
-  const Score storedEval = valueToTt(eval, ply);
+  const TTBucket& bucket = bucketOf(hashValue);
 
-  const auto addEntry = [&] (ZobristHashKey& key)
+  for (size_t i = 0; i < TTBucket::ENTRIES; i++)
   {
-    key.hashValue = hashValue;
-    key.pack(storedEval, depth, flag, bestMove);
-  };
-
-  size_t index = hashValue % TT_SIZE;
-
-  if (depth > ttPrimary[index].depth())
-    addEntry(ttPrimary[index]);
+    const TTEntry& entry = bucket.entries[i];
+    if (!entry.empty() and bucket.keys[i] == keyCheck(hashValue, entry.data))
+      return &entry;
+  }
 
-  addEntry(ttSecondary[index]);
+  return nullptr;
 }
 
-int
-TranspositionTable::lookupPosition
-  (uint64_t hashValue, Depth depth, Ply ply, Score alpha, Score beta, Move& outMove, bool& ttHit) const noexcept
+void
+TranspositionTable::recordPosition
+    (uint64_t hashValue, Depth depth, Ply ply, Score eval, Flag flag, Move bestMove) noexcept
 {
-  const auto probe = [&] (const ZobristHashKey &key) -> int
+  TTBucket& bucket = bucketOf(hashValue);
+
+  // Pick the slot to write. A slot already holding this position is always
+  // reused — one position never occupies two slots. Otherwise the victim is
+  // the slot worth least, where worth is the depth the entry was searched to
+  // minus a penalty for every search it has sat through unused. A deep entry
+  // from a few moves ago still beats a shallow one from this search, but it
+  // cannot squat on the bucket forever the way pure depth-preferred did.
+  size_t victim = 0;
+  int victimWorth = std::numeric_limits<int>::max();
+
+  for (size_t i = 0; i < TTBucket::ENTRIES; i++)
   {
-    if (key.hashValue != hashValue)
-      return VALUE_UNKNOWN;
+    const TTEntry& entry = bucket.entries[i];
 
-    ttHit = true;
+    if (entry.empty())
+    {
+      victim = i;
+      break;
+    }
 
-    // Hash match — surface the stored move for ordering, even when the
-    // entry's depth is too shallow to produce a cutoff.
-    if (outMove == NULL_MOVE)
-      outMove = key.bestMove();
+    if (bucket.keys[i] == keyCheck(hashValue, entry.data))
+    {
+      // Same position: keep the old move if this visit found none, and don't
+      // let a shallow non-exact re-search overwrite a deeper result from the
+      // current search. A quiescence store never replaces a searched entry,
+      // exact or not, of any generation: it would trade the entry's depth and
+      // hash move for a depth-0 bound that can never cut a main-search node.
+      if (depth == 0 and entry.depth() > 0)
+        return;
+      if (bestMove == NULL_MOVE)
+        bestMove = entry.bestMove();
+      if (flag != Flag::HASH_EXACT and entry.generation() == generation
+          and depth + 2 < entry.depth())
+        return;
+      victim = i;
+      break;
+    }
 
-    if (key.depth() >= depth)
+    const int age   = uint8_t(generation - entry.generation());
+    const int worth = int(entry.depth()) - 4 * age;
+    if (worth < victimWorth)
     {
-      Flag flag = key.flag();
-      // Back to root-relative *before* the bound tests — alpha and beta are
-      // root-relative, so comparing a node-relative mate against them would
-      // cut off on the wrong distance.
-      Score eval = valueFromTt(key.eval(), ply);
-      if (flag == Flag::HASH_EXACT) return eval;
-      if (flag == Flag::HASH_ALPHA and eval <= alpha) return alpha;
-      if (flag == Flag::HASH_BETA  and eval >= beta ) return beta;
+      victim = i;
+      victimWorth = worth;
     }
+  }
 
-    return VALUE_UNKNOWN;
-  };
+  // Store mate scores as a distance from *this* node, not from the root.
+  TTEntry& entry = bucket.entries[victim];
+  entry.pack(valueToTt(eval, ply), depth, flag, bestMove, generation);
+  bucket.keys[victim] = keyCheck(hashValue, entry.data);
+}
 
+int
+TranspositionTable::lookupPosition
+  (uint64_t hashValue, Depth depth, Ply ply, Score alpha, Score beta, Move& outMove, bool& ttHit) const noexcept
+{
   outMove = NULL_MOVE;
   ttHit = false;
 
-  size_t index = hashValue % TT_SIZE;
+  const TTEntry* entry = findEntry(hashValue);
+  if (entry == nullptr)
+    return VALUE_UNKNOWN;
 
-  int res = probe(ttPrimary[index]);
-  if (res != VALUE_UNKNOWN) return res;
+  ttHit = true;
 
-  return probe(ttSecondary[index]);
+  // Hash match — surface the stored move for ordering, even when the
+  // entry's depth is too shallow to produce a cutoff.
+  outMove = entry->bestMove();
+
+  if (entry->depth() >= depth)
+  {
+    Flag flag = entry->flag();
+    // Back to root-relative *before* the bound tests — alpha and beta are
+    // root-relative, so comparing a node-relative mate against them would
+    // cut off on the wrong distance.
+    Score eval = valueFromTt(entry->eval(), ply);
+    if (flag == Flag::HASH_EXACT) return eval;
+    if (flag == Flag::HASH_ALPHA and eval <= alpha) return alpha;
+    if (flag == Flag::HASH_BETA  and eval >= beta ) return beta;
+  }
+
+  return VALUE_UNKNOWN;
 }
 
 Move
@@ -172,27 +264,32 @@ TranspositionTable::probePvMove(uint64_t hashValue, Depth minDepth) const noexce
   // not best. Handing either to the PV printer manufactures analysis: it takes
   // one bogus link for every probe past it to be asking about a position that
   // was never on the line at all.
-  const auto probe = [&] (const ZobristHashKey& key) -> Move
-  {
-    if (key.hashValue != hashValue)
-      return NULL_MOVE;
-    if (key.flag() != Flag::HASH_EXACT or key.depth() < minDepth)
-      return NULL_MOVE;
-    return key.bestMove();
-  };
-
-  size_t index = hashValue % TT_SIZE;
-
-  Move move = probe(ttPrimary[index]);
-  if (move != NULL_MOVE)
-    return move;
+  const TTEntry* entry = findEntry(hashValue);
 
-  return probe(ttSecondary[index]);
+  if (entry == nullptr)
+    return NULL_MOVE;
+  if (entry->flag() != Flag::HASH_EXACT or entry->depth() < minDepth)
+    return NULL_MOVE;
+  return entry->bestMove();
 }
 
 void
 TranspositionTable::clear() noexcept
 {
-  for (size_t i = 0; i < TT_SIZE; i++)
-    ttPrimary[i].hashValue = ttSecondary[i].hashValue = 0;
+  // The buckets are plain data and all-zero is the empty state, so each
+  // thread just memsets its own contiguous slice. Splitting by slice rather
+  // than by bucket also means each thread faults in (and, for a fresh table,
+  // first-touches) its own pages.
+  const int threads = std::max(1, omp_get_max_threads());
+  const size_t chunk = (TT_SIZE + size_t(threads) - 1) / size_t(threads);
+
+  #pragma omp parallel for num_threads(threads) schedule(static)
+  for (int t = 0; t < threads; t++)
+  {
+    const size_t start = std::min(TT_SIZE, size_t(t) * chunk);
+    const size_t len   = std::min(TT_SIZE - start, chunk);
+    std::memset(static_cast<void*>(buckets + start), 0, len * sizeof(TTBucket));
+  }
+
+  generation = 0;
 }
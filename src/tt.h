@@ -11,22 +11,28 @@
 using std::array;
 
 /**
- * Packed TT entry — 16 bytes total.
+ * Packed TT entry — one 64-bit data word.
  *
  * `data` layout (uint64_t):
  *   bits  0..23 → bestMove   (24 bits, matches Move encoding width)
  *   bits 24..31 → depth      (8 bits, unsigned)
  *   bits 32..33 → flag       (2 bits)
  *   bits 34..49 → eval       (16-bit signed, fits VALUE_INF = 16001)
- *   bits 50..63 → reserved   (14 bits — aging, etc.)
+ *   bits 50..57 → generation (8 bits, search the entry was last written in)
+ *   bits 58..63 → reserved
+ *
+ * The entry's key check lives beside it in the owning TTBucket, not here.
  */
-class ZobristHashKey
+class TTEntry
 {
   public:
-  Bitboard hashValue;
   uint64_t data;
 
-  ZobristHashKey() : hashValue(0), data(0) {}
+  TTEntry() : data(0) {}
+
+  inline bool
+  empty() const noexcept
+  { return data == 0; }
 
   inline Move
   bestMove() const noexcept
@@ -48,39 +54,72 @@ class ZobristHashKey
     return Score(v);
   }
 
+  inline uint8_t
+  generation() const noexcept
+  { return uint8_t((data >> 50) & 0xFFULL); }
+
   inline void
-  pack(Score eval, Depth depth, Flag flag, Move bestMove) noexcept
+  pack(Score eval, Depth depth, Flag flag, Move bestMove, uint8_t generation) noexcept
   {
     data = (uint64_t(bestMove) & 0xFFFFFFULL)
          | ((uint64_t(depth) & 0xFFULL) << 24)
          | ((uint64_t(flag)  & 0x3ULL) << 32)
-         | ((uint64_t(uint16_t(int16_t(eval))) & 0xFFFFULL) << 34);
+         | ((uint64_t(uint16_t(int16_t(eval))) & 0xFFFFULL) << 34)
+         | ((uint64_t(generation) & 0xFFULL) << 50);
   }
 
   void
   show() const noexcept
   {
     std::cout
-      << "Key = " << hashValue << '\n'
       << "Depth = " << depth() << '\n'
       << "Eval = " << eval() << '\n'
       << "Flag = " << int(flag()) << '\n'
+      << "Generation = " << int(generation()) << '\n'
       << "BestMove = " << bestMove() << std::endl;
   }
 };
 
-class TranspositionTable
+/**
+ * One cache line of the table — every probe and store touches exactly one.
+ *
+ * Keys and data words are kept as two arrays rather than as an array of
+ * {key, data} pairs: a 10-byte pair would either need packing (misaligned
+ * 64-bit loads) or pad out to 16 bytes and fit only four entries per line.
+ * Split, six entries fit in 60 bytes.
+ *
+ * keys[i] holds the low 16 bits of the position's hash, XOR-folded with
+ * entries[i].data (see TranspositionTable::keyCheck). The bucket index is
+ * taken from the high bits of the hash (see TranspositionTable::bucketOf), so
+ * the low 16 are what is left to tell two positions sharing a bucket apart.
+ */
+struct alignas(64) TTBucket
 {
-  /**
-   * 0 ->  66 MB tableSize
-   * 1 -> 686 MB tableSize
-  */
-  array<uint64_t, 2> ttSizes = { 2189477ULL, 22508861ULL };
+  static constexpr size_t ENTRIES = 6;
 
+  uint16_t keys[ENTRIES];
+  uint16_t padding[2];
+  TTEntry  entries[ENTRIES];
+
+  TTBucket() : keys{}, padding{} {}
+};
+
+static_assert(sizeof(TTBucket) == 64, "TTBucket must fill exactly one cache line");
+
+class TranspositionTable
+{
+  // Number of buckets. Always a power of two, so the table is exactly the
+  // requested size whenever the request is a power of two MB.
   size_t TT_SIZE = 0;
 
-  ZobristHashKey *ttPrimary;
-  ZobristHashKey *ttSecondary;
+  TTBucket *buckets = nullptr;
+
+  // Lets `elsa prefetch` time the same search with and without prefetching.
+  bool prefetchEnabled = true;
+
+  // Bumped once per search. Entries written in an older generation lose
+  // their claim to a bucket slot as they age, however deep they were.
+  uint8_t generation = 0;
 
   array<uint64_t, HASH_INDEXES_SIZE> hashIndex;
 
@@ -88,6 +127,30 @@ class TranspositionTable
 
   void freeTables();
 
+  // Map a hash to its bucket: the high half of hashValue * TT_SIZE, i.e. a
+  // fixed-point scaling of the hash into [0, TT_SIZE). One multiply instead of
+  // the 64-bit division `hashValue % TT_SIZE` cost on every probe and store.
+  TTBucket&
+  bucketOf(uint64_t hashValue) const noexcept
+  { return buckets[size_t((__uint128_t(hashValue) * TT_SIZE) >> 64)]; }
+
+  // The 16-bit check stored beside an entry: the key's low bits XOR-folded
+  // with the whole data word. Lazy-SMP threads write the table without
+  // locks, so a key and data word can come from two different stores; folding
+  // the data in makes such a torn pair fail the check instead of pairing one
+  // position's key with another position's move and bound.
+  static uint16_t
+  keyCheck(uint64_t hashValue, uint64_t data) noexcept
+  {
+    data ^= data >> 32;
+    data ^= data >> 16;
+    return uint16_t(hashValue ^ data);
+  }
+
+  // Entry in the bucket whose check matches `hashValue`, or nullptr.
+  const TTEntry*
+  findEntry(uint64_t hashValue) const noexcept;
+
   public:
   // Initialize Transposition Table
   TranspositionTable() { }
@@ -97,18 +160,46 @@ class TranspositionTable
   // be callable even when USE_TT is false. resize() also calls it.
   void getRandomKeys() noexcept;
 
-  TranspositionTable(int preset)
-  { resize(preset); }
+  TranspositionTable(size_t megabytes)
+  { resize(megabytes); }
+
+  ~TranspositionTable()
+  { freeTables(); }
 
+  // Reallocate the table to the largest power-of-two bucket count that fits in
+  // `megabytes` (clamped to 1..MAX_HASH_MB), and clear it.
   void
-  resize(int preset = 0);
+  resize(size_t megabytes = DEFAULT_HASH_MB);
 
   std::string
   size() const noexcept;
 
+  // Zero every bucket. Split across all cores: a multi-GB table cleared on
+  // one thread stalls `ucinewgame` for seconds.
   void
   clear() noexcept;
 
+  // Start loading the bucket for `hashValue` into cache without waiting for
+  // it. Issued for a child position before makeMove, so the DRAM round trip
+  // overlaps the move bookkeeping and the child's prelude instead of stalling
+  // its probe. Only a hint: a wrong key just wastes a line fill.
+  void
+  prefetch(uint64_t hashValue) const noexcept
+  {
+    if (prefetchEnabled)
+      __builtin_prefetch(&bucketOf(hashValue));
+  }
+
+  void
+  setPrefetch(bool enabled) noexcept
+  { prefetchEnabled = enabled; }
+
+  // Start a new search generation. Call once per `go`, before any thread
+  // touches the table.
+  void
+  newSearch() noexcept
+  { ++generation; }
+
   uint64_t
   hashKey(int pos) const noexcept
   { return hashIndex[pos]; }
@@ -129,8 +220,6 @@ class TranspositionTable
   // a principal variation. Returns NULL_MOVE unless the entry actually proved
   // the move: HASH_EXACT (a fail-low entry's move was never proven best — it is
   // just whatever was left standing) and searched to at least `minDepth`.
-  // Both those conditions are checked per table, so a primary entry that fails
-  // them still falls through to the secondary.
   Move
   probePvMove(uint64_t hashValue, Depth minDepth) const noexcept;
 };
@@ -69,9 +69,15 @@ enum Search
   RFP_MAX_DEPTH = 6,
   RAZOR_MAX_DEPTH = 3,
   FUTILITY_MAX_DEPTH = 4,
+  HISTORY_MAX = 16384,
+  HISTORY_LMR_DIVISOR = 16384,
   TIMEOUT = 1112223334,
   DEFAULT_SEARCH_TIME = 1,
-  MAX_THREADS = 12,
+  MAX_THREADS = 64,
+  CLOCK_POLL_INTERVAL = 1024,
+  MAX_MULTI_PV = 32,
+  DEFAULT_HASH_MB = 64,
+  MAX_HASH_MB = 65536,
   // The triangular PV rows need (MAX_PLY * (MAX_PLY + 1)) / 2 words; the +1 is a
   // spare slot that is never part of any row. quiescenceSearch writes
   // pvArray[pvIndex] = NULL_MOVE unguarded, and the pvIndex it hands its children
@@ -81,6 +87,10 @@ enum Search
   // any MAX_PLY. The spare word absorbs that write instead of clobbering whatever
   // follows pvArray in BSS (killerMoves).
   MAX_PV_ARRAY_SIZE = (MAX_PLY * (MAX_PLY + 1)) / 2 + 1,
+  // Slots of the per-ply move stack (search_utils.h). alphaBeta stays below
+  // MAX_PLY (see the static_assert below); quiescence then adds one ply per
+  // capture, and a board holds at most 30 pieces to capture.
+  MOVE_STACK_SIZE = MAX_PLY + 32,
 
   NULL_MOVE = 0,
 };
@@ -206,11 +216,16 @@ enum class MType: uint8_t
  *                (and stamps the active color onto the MoveList).
  * GEN_MOVES    - the actual moves (pins, pawns, sliders/knights, king + castling).
  * GEN_CHECKS   - discovered-check / check-giving-square data (search-only).
+ * GEN_CAPTURES - GEN_MOVES cut down to captures and en passant (no pushes, quiet
+ *                promotions or castling), plus the safe king steps (quiescence).
+ * GEN_EVASIONS - GEN_MOVES for a side in check, without the castling test.
  *
- * GEN_METADATA must run first; GEN_MOVES depends on it. GEN_CHECKS is independent
- * of GEN_MOVES and only reads the board.
+ * GEN_METADATA must run first; the move stages depend on it. GEN_CHECKS is
+ * independent of them and only reads the board. GEN_MOVES may follow
+ * GEN_CAPTURES on the same list: every square it writes is a superset of the
+ * capture one, so the result is the full move list.
  */
-enum MoveGenStage { GEN_METADATA, GEN_MOVES, GEN_CHECKS };
+enum MoveGenStage { GEN_METADATA, GEN_MOVES, GEN_CHECKS, GEN_CAPTURES, GEN_EVASIONS };
 
 
 // Toggle color
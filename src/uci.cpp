@@ -3,12 +3,14 @@
 #include "bitboard.h"
 #include "movegen.h"
 #include "move_utils.h"
+#include "nnue.h"
 #include "search.h"
 #include "single_thread.h"
 #include "tt.h"
 
 #include <algorithm>
 #include <atomic>
+#include <cctype>
 #include <iostream>
 #include <mutex>
 #include <sstream>
@@ -37,6 +39,15 @@ ChessBoard g_board(START_FEN);
 // worker before starting anything that touches that shared state.
 std::thread g_worker;
 
+// Lazy-SMP search threads, set by `setoption name Threads`. The calling worker
+// is the main search thread, so 1 means no helpers. Only the UCI thread reads
+// or writes it.
+size_t g_threads = 1;
+
+// Lines reported per iteration, set by `setoption name MultiPV`. Same
+// ownership as g_threads.
+size_t g_multiPv = 1;
+
 // Raise the abort flag (polled by the search via SearchData::shouldStop) and
 // wait for the worker to unwind and emit its `bestmove`. Safe to call when no
 // search is running. `searchStop` is left set; handleGo clears it before the
@@ -56,9 +67,86 @@ sendId()
 {
   uciSend("id name Elsa");
   uciSend("id author Andr0human");
+  uciSend("option name Threads type spin default 1 min 1 max " + std::to_string(int(MAX_THREADS)));
+  if constexpr (USE_TT) {
+    uciSend("option name Hash type spin default " + std::to_string(int(DEFAULT_HASH_MB))
+          + " min 1 max " + std::to_string(int(MAX_HASH_MB)));
+  }
+  uciSend("option name EvalFile type string default <empty>");
+  uciSend("option name UseNNUE type check default true");
+  uciSend("option name Ponder type check default false");
+  uciSend("option name MultiPV type spin default 1 min 1 max " + std::to_string(int(MAX_MULTI_PV)));
   uciSend("uciok");
 }
 
+// setoption name <id> [value <x>]. The name may contain spaces, so it runs up
+// to the `value` token. Names are matched case-insensitively, as GUIs differ.
+void
+handleSetOption(stringstream& ss)
+{
+  string token, name, value;
+
+  if (!(ss >> token) or token != "name")
+    return;
+
+  while (ss >> token and token != "value")
+    name += (name.empty() ? "" : " ") + token;
+
+  while (ss >> token)
+    value += (value.empty() ? "" : " ") + token;
+
+  std::transform(name.begin(), name.end(), name.begin(),
+    [] (unsigned char ch) { return char(std::tolower(ch)); });
+
+  if (name == "threads")
+  {
+    try {
+      g_threads = size_t(std::clamp(std::stoi(value), 1, int(MAX_THREADS)));
+    } catch (...) { }
+  }
+  else if (name == "multipv")
+  {
+    try {
+      g_multiPv = size_t(std::clamp(std::stoi(value), 1, int(MAX_MULTI_PV)));
+    } catch (...) { }
+  }
+  else if (name == "hash")
+  {
+    if constexpr (USE_TT) {
+      try {
+        const int megabytes = std::clamp(std::stoi(value), 1, int(MAX_HASH_MB));
+        // The table is shared with any running search; never pull it out
+        // from under one.
+        stopAndJoin();
+        tt.resize(size_t(megabytes));
+      } catch (...) { }
+    }
+  }
+  else if (name == "evalfile")
+  {
+    // Evaluation must not change under a running search.
+    stopAndJoin();
+
+    if (value.empty() or value == "<empty>")
+    {
+      nnue::unload();
+      return;
+    }
+
+    string error;
+    if (nnue::load(value, error))
+      uciSend("info string NNUE network loaded from " + value);
+    else
+      uciSend("info string NNUE network not loaded: " + error);
+  }
+  else if (name == "usennue")
+  {
+    stopAndJoin();
+    nnue::setUseNnue(value == "true");
+  }
+  // Unknown options are ignored silently.
+}
+
 void
 handlePosition(stringstream& ss)
 {
@@ -119,13 +207,31 @@ handlePosition(stringstream& ss)
 // think time at blitz. Tune up if time-losses ever appear over an external GUI.
 constexpr double MOVE_OVERHEAD = 0.040;  // seconds
 
+// Soft limit as a fraction of the per-move target, and the hard limit as a
+// multiple of it. The soft limit only gates starting an iteration, and an
+// iteration started just under it runs about as long again (the tree roughly
+// doubles per depth), so 0.6 puts the average spend near the target. The hard
+// limit leaves room for the iterations the soft scaling stretches, when the
+// score is falling or the best move keeps changing.
+constexpr double SOFT_TIME_RATIO = 0.6;
+constexpr double HARD_TIME_RATIO = 3.0;
+
+// Per-move time limits in seconds, see search() for how each is used.
+struct TimeBudget
+{
+  double soft;
+  double hard;
+};
+
 // Decide how long to search given the side-to-move's remaining clock and
-// increment (both in milliseconds). Faithful 1:1 port of the heuristic that
-// used to live on the Unity side (ChessEngine.DecideTimeForSearch): the GUI
-// now forwards the raw clock and the engine owns the time-management decision
-// — the correct UCI split. Returns the budget in seconds.
-double
-decideSearchTime(long long sideTimeMs, long long sideIncMs)
+// increment (both in milliseconds), and the moves left to the next time
+// control (0 when the clock is sudden death). The target comes from the
+// heuristic that used to live on the Unity side (ChessEngine.DecideTimeForSearch):
+// the GUI forwards the raw clock and the engine owns the time-management
+// decision — the correct UCI split. The soft and hard limits are spread
+// around that target.
+TimeBudget
+decideSearchTime(long long sideTimeMs, long long sideIncMs, int movesToGoHint)
 {
   // Shave the overhead off the usable clock up front so both the budget formula
   // and the 62% cap below plan against time we can actually afford to spend.
@@ -146,31 +252,72 @@ decideSearchTime(long long sideTimeMs, long long sideIncMs)
       500.0 * g_board.count<ROOK>()   +
       900.0 * g_board.count<QUEEN>();
 
-  const double movesToGo =
+  double movesToGo =
       maxMoves - (((maxWeight - currentWeight) / 400.0) * 1.3);
 
-  double searchTime = ((timeLeft + increment) / movesToGo) + (0.6 * increment);
+  // With a move-count time control the clock is refilled after movestogo
+  // moves, so there is no point saving time for the moves beyond it.
+  if (movesToGoHint > 0)
+    movesToGo = std::min(movesToGo, double(movesToGoHint));
+
+  const double target = ((timeLeft + increment) / movesToGo) + (0.6 * increment);
 
-  // Never spend more than 62% of the remaining clock on one move.
-  searchTime = std::min(searchTime, 0.62 * timeLeft);
+  // Never spend more than 62% of the remaining clock on one move. Floor at
+  // 1 ms so the search always gets a sane positive budget (matches the
+  // Mathf.Max(1, ...) the Unity send site applied).
+  const double hard = std::max(std::min(HARD_TIME_RATIO * target, 0.62 * timeLeft), 0.001);
+  const double soft = std::max(std::min(SOFT_TIME_RATIO * target, hard), 0.001);
 
-  // Floor at 1 ms so the search always gets a sane positive budget
-  // (matches the Mathf.Max(1, ...) the Unity send site applied).
-  return std::max(searchTime, 0.001);
+  return {soft, hard};
+}
+
+// `bestmove <move>`, with `ponder <reply>` when the last completed iteration's
+// PV goes on past our move: the reply the search expects, and so the position
+// worth searching on the opponent's time.
+string
+bestMoveLine()
+{
+  const Move bestMove = info.lastIterationResult().first;
+  const auto& pvLine = info.getPvLine();
+
+  string line = "bestmove " + moveToUci(bestMove);
+  if (pvLine.size() >= 2 and filter(pvLine[0]) == filter(bestMove))
+    line += " ponder " + moveToUci(pvLine[1]);
+
+  return line;
 }
 
 void
 handleGo(stringstream& ss)
 {
-  // Parse a subset of UCI go: movetime, wtime/btime/winc/binc, depth, infinite.
+  // Parse UCI go: movetime, wtime/btime/winc/binc, movestogo, depth, nodes,
+  // mate, searchmoves, infinite, ponder.
   double moveTimeSec = -1.0;
   Depth maxDepth = MAX_DEPTH;
+  SearchLimits limits;
+  limits.multiPv = g_multiPv;
 
   long long wtime = -1, btime = -1, winc = 0, binc = 0;
+  int movesToGo = 0;
+  bool ponder = false;
+  bool readingSearchMoves = false;
 
   string token;
   while (ss >> token)
   {
+    // searchmoves takes every following token that is a move; the first one
+    // that is not ends the list and is parsed as a keyword below.
+    if (readingSearchMoves)
+    {
+      const Move move = moveFromUci(token, g_board);
+      if (move != NULL_MOVE)
+      {
+        limits.searchMoves.add(move);
+        continue;
+      }
+      readingSearchMoves = false;
+    }
+
     if (token == "movetime")
     {
       long long ms = 0;
@@ -181,6 +328,7 @@ handleGo(stringstream& ss)
     else if (token == "btime") { ss >> btime; }
     else if (token == "winc")  { ss >> winc;  }
     else if (token == "binc")  { ss >> binc;  }
+    else if (token == "movestogo") { ss >> movesToGo; }
     else if (token == "depth")
     {
       int d = 0;
@@ -191,19 +339,47 @@ handleGo(stringstream& ss)
     {
       moveTimeSec = 1e9;
     }
+    else if (token == "nodes")
+    {
+      long long n = 0;
+      ss >> n;
+      limits.nodes = Nodes(std::max(n, 0LL));
+    }
+    else if (token == "mate")
+    {
+      ss >> limits.mate;
+      limits.mate = std::max(limits.mate, 0);
+    }
+    else if (token == "searchmoves")
+    {
+      readingSearchMoves = true;
+    }
+    else if (token == "ponder")
+    {
+      ponder = true;
+    }
     // Unknown tokens are ignored silently.
   }
 
   if (moveTimeSec < 0)
   {
-    // No explicit movetime: derive a search budget from the side-to-move's
-    // clock (or fall back to the default if no clock was provided).
+    // No explicit movetime: derive soft and hard limits from the side-to-move's
+    // clock. Without a clock, `go nodes` and `go mate` run until their own
+    // limit is met; anything else gets the default time. A fixed movetime
+    // keeps the soft limit at 0 and is searched in full.
     long long sideTime = (g_board.color == WHITE) ? wtime : btime;
     long long sideInc  = (g_board.color == WHITE) ? winc  : binc;
 
-    moveTimeSec = (sideTime > 0)
-        ? decideSearchTime(sideTime, sideInc)
-        : double(DEFAULT_SEARCH_TIME);
+    if (sideTime > 0)
+    {
+      const TimeBudget budget = decideSearchTime(sideTime, sideInc, movesToGo);
+      moveTimeSec = budget.hard;
+      limits.softTime = budget.soft;
+    }
+    else if (limits.nodes or limits.mate)
+      moveTimeSec = 1e9;
+    else
+      moveTimeSec = double(DEFAULT_SEARCH_TIME);
   }
 
   // Stop any prior search and launch this one on the worker. The board is
@@ -211,13 +387,24 @@ handleGo(stringstream& ss)
   // search. The worker prints `bestmove` when search() returns — whether it
   // ended by depth/time or an async `stop`. Iterative-deepening table dumps go
   // to a discarded sink; only the UCI `info`/`bestmove` lines reach stdout.
+  //
+  // A ponder search is launched with the limits of a normal one and runs
+  // untimed until `ponderhit` (see searchPonder). It may not answer before the
+  // GUI resolves it, so if it ends early (depth limit, mate found) it waits for
+  // `ponderhit` or `stop`.
   stopAndJoin();
   searchStop.store(false, std::memory_order_relaxed);
+  searchPonder.store(ponder, std::memory_order_relaxed);
 
-  g_worker = std::thread([board = g_board, maxDepth, moveTimeSec]() {
+  g_worker = std::thread([board = g_board, maxDepth, moveTimeSec, limits, threads = g_threads]() {
     std::ostringstream sink;
-    search(board, maxDepth, moveTimeSec, sink, false, true);
-    uciSend("bestmove " + moveToUci(info.lastIterationResult().first));
+    search(board, maxDepth, moveTimeSec, sink, false, true, threads, limits);
+
+    while (searchPonder.load(std::memory_order_relaxed)
+       and !searchStop.load(std::memory_order_relaxed))
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    uciSend(bestMoveLine());
   });
 }
 
@@ -272,18 +459,30 @@ uciLoop()
     {
       handleGo(ss);
     }
+    else if (cmd == "ponderhit")
+    {
+      // The opponent played the move we were pondering on: the running search
+      // is now our own and its time limits apply from here on.
+      searchPonder.store(false, std::memory_order_relaxed);
+    }
     else if (cmd == "stop")
     {
       // Raise the abort flag; the worker observes it at its next checkpoint,
       // unwinds, and prints `bestmove`. It is joined on the next go/quit.
       searchStop.store(true, std::memory_order_relaxed);
     }
+    else if (cmd == "setoption")
+    {
+      // Options only take effect on the next `go`; a running search keeps the
+      // settings it was launched with.
+      handleSetOption(ss);
+    }
     else if (cmd == "quit")
     {
       stopAndJoin();
       break;
     }
-    // Silently accept: debug, setoption, register, ponderhit, etc.
+    // Silently accept: debug, register, etc.
   }
 
   // Reached on EOF (stdin closed) without an explicit `quit`: never let a
@@ -4,17 +4,26 @@
 
 #include <array>
 #include <cstddef>
+#include <type_traits>
 
 using std::array;
 
+// Fixed-capacity vector. Slots past size() are left uninitialised: a MoveArray
+// is 1 KB, and the search builds one per node, so zeroing it there costs more
+// than filling it. Only constant initialisation (the constinit thread_local
+// tables) zeroes them, as it has to initialise every member.
 template <typename T, size_t Nm>
 class Varray {
   size_t Nc;
-  array<T, Nm> _array{};
+  array<T, Nm> _array;
 
   public:
 
-  Varray() : Nc(0) {}
+  constexpr Varray() : Nc(0)
+  {
+    if (std::is_constant_evaluated())
+      _array = {};
+  }
 
   void add(T val) noexcept
   { if (Nc < Nm) _array[Nc++] = val; }